@@ -67,6 +67,8 @@ extern "C"
     AsstSize ASSTAPI AsstGetImage(AsstHandle handle, void* buff, AsstSize buff_size);
     AsstSize ASSTAPI AsstGetUUID(AsstHandle handle, char* buff, AsstSize buff_size);
     AsstSize ASSTAPI AsstGetTasksList(AsstHandle handle, AsstTaskId* buff, AsstSize buff_size);
+    AsstSize ASSTAPI AsstGetMetrics(AsstHandle handle, char* buff, AsstSize buff_size);
+    AsstBool ASSTAPI AsstClearMetrics(AsstHandle handle);
     AsstSize ASSTAPI AsstGetNullSize();
 
     ASSTAPI_PORT const char* ASST_CALL AsstGetVersion();
@@ -7,9 +7,9 @@
 #include "Config/GeneralConfig.h"
 #include "Config/Miscellaneous/OcrPack.h"
 #include "Config/OnnxSessions.h"
-#include "Config/ResourceLoader.h"
 #include "Controller/Controller.h"
 #include "Status.h"
+#include "TaskMetrics.h"
 #include "Task/Interface/AwardTask.h"
 #include "Task/Interface/CloseDownTask.h"
 #include "Task/Interface/CopilotTask.h"
@@ -51,6 +51,14 @@ bool ::AsstExtAPI::set_static_option(StaticOptionKey key, const std::string& val
         OnnxSessions::get_instance().use_gpu(device_id);
         return true;
     } break;
+    case StaticOptionKey::AsyncLog: {
+        if (value != "0" && value != "1") {
+            Log.error(__FUNCTION__, "| invalid value:", value);
+            return false;
+        }
+        Log.set_async(value == "1");
+        return true;
+    } break;
     default:
         Log.error(__FUNCTION__, "| unknown key:", static_cast<int>(key));
         break;
@@ -66,6 +74,7 @@ Assistant::Assistant(ApiCallback callback, void* callback_arg) :
     LogTraceFunction;
 
     m_status = std::make_shared<Status>();
+    m_metrics = std::make_shared<TaskMetrics>();
     m_ctrler = std::make_shared<Controller>(append_callback_for_inst, this);
 
     m_msg_thread = std::thread(&Assistant::msg_proc, this);
@@ -77,10 +86,6 @@ Assistant::~Assistant()
 {
     LogTraceFunction;
 
-    // dirty stuff preventing Logger from being destructed before ResourceLoader::load_thread_func exits,
-    // which creates empty files with random name on Linux. I have no idea how this could work
-    ResourceLoader::get_instance().cancel();
-
     m_thread_exit = true;
     m_thread_idle = true;
 
@@ -163,6 +168,22 @@ bool asst::Assistant::set_instance_option(InstanceOptionKey key, const std::stri
             return true;
         }
         break;
+    case InstanceOptionKey::Profiling:
+        // 记录是进程级的，所有实例共享同一份
+        if (constexpr std::string_view Enable = "1"; value == Enable) {
+            Profiler::get_instance().start();
+            return true;
+        }
+        else if (constexpr std::string_view Disable = "0"; value == Disable) {
+            auto path = UserDir.get() / "debug" / "profile" / utils::path(utils::get_time_filestem() + ".json");
+            if (!Profiler::get_instance().stop_and_export(path)) {
+                Log.error("failed to export profile to", path);
+                return false;
+            }
+            Log.info("profile exported to", path);
+            return true;
+        }
+        break;
     default:
         break;
     }
@@ -352,6 +373,16 @@ std::string asst::Assistant::get_uuid() const
     return m_uuid;
 }
 
+std::string asst::Assistant::get_metrics() const
+{
+    return m_metrics->to_json().to_string();
+}
+
+void asst::Assistant::clear_metrics()
+{
+    m_metrics->clear();
+}
+
 std::vector<Assistant::TaskId> asst::Assistant::get_tasks_list() const
 {
     std::unique_lock<std::mutex> lock(m_mutex);
@@ -59,6 +59,10 @@ public:
     virtual std::string get_uuid() const = 0;
     // 获取任务列表
     virtual std::vector<TaskId> get_tasks_list() const = 0;
+    // 获取识别耗时统计，json 格式
+    virtual std::string get_metrics() const = 0;
+    // 清空识别耗时统计
+    virtual void clear_metrics() = 0;
 
     virtual bool back_to_home() const = 0;
 };
@@ -68,6 +72,7 @@ namespace asst
 class Controller;
 class InterfaceTask;
 class Status;
+class TaskMetrics;
 
 class Assistant : public AsstExtAPI
 {
@@ -98,6 +103,8 @@ public:
     virtual std::vector<unsigned char> get_image() const override;
     virtual std::string get_uuid() const override;
     virtual std::vector<TaskId> get_tasks_list() const override;
+    virtual std::string get_metrics() const override;
+    virtual void clear_metrics() override;
 
     virtual bool back_to_home() const override;
 
@@ -106,6 +113,8 @@ public:
 
     std::shared_ptr<Status> status() const { return m_status; }
 
+    std::shared_ptr<TaskMetrics> metrics() const { return m_metrics; }
+
     bool need_exit() const { return m_thread_idle && m_running; }
 
 private:
@@ -166,6 +175,7 @@ private:
 
     std::shared_ptr<Controller> m_ctrler = nullptr;
     std::shared_ptr<Status> m_status = nullptr;
+    std::shared_ptr<TaskMetrics> m_metrics = nullptr;
 
     std::atomic_bool m_thread_exit = false;
     std::list<std::pair<TaskId, std::shared_ptr<InterfaceTask>>> m_tasks_list;
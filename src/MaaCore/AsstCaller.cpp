@@ -259,6 +259,35 @@ AsstSize AsstGetTasksList(AsstHandle handle, AsstTaskId* buff, AsstSize buff_siz
     return data_size;
 }
 
+AsstSize AsstGetMetrics(AsstHandle handle, char* buff, AsstSize buff_size)
+{
+    if (!inited() || handle == nullptr) {
+        return NullSize;
+    }
+    auto metrics = handle->get_metrics();
+    size_t data_size = metrics.size();
+    // 和 snprintf 一样，返回值不含结尾的 '\0'；返回值 >= buff_size 说明没放下，按返回值 + 1 重新申请
+    if (buff == nullptr || buff_size <= data_size) {
+        if (buff != nullptr && buff_size > 0) {
+            buff[0] = '\0';
+        }
+        return data_size;
+    }
+    memcpy(buff, metrics.data(), data_size * sizeof(decltype(metrics)::value_type));
+    buff[data_size] = '\0';
+    return data_size;
+}
+
+AsstBool AsstClearMetrics(AsstHandle handle)
+{
+    if (!inited() || handle == nullptr) {
+        return AsstFalse;
+    }
+
+    handle->clear_metrics();
+    return AsstTrue;
+}
+
 AsstSize AsstGetNullSize()
 {
     return NullSize;
@@ -32,6 +32,7 @@ enum class StaticOptionKey
     CpuOCR = 1, // use CPU to OCR, no value. It does not support switching after the resource is loaded.
     GpuOCR = 2, // use GPU to OCR, value is gpu_id int to string. It does not support switching after the resource
                 // is loaded.
+    AsyncLog = 3, // write log in a background thread, "0" | "1".
 };
 
 enum class InstanceOptionKey
@@ -42,6 +43,7 @@ enum class InstanceOptionKey
     DeploymentWithPause = 3, // 自动战斗、肉鸽、保全 是否使用 暂停下干员， "0" | "1"
     AdbLiteEnabled = 4,      // 是否使用 AdbLite， "0" | "1"
     KillAdbOnExit = 5,       // 退出时是否杀掉 Adb 进程， "0" | "1"
+    Profiling = 6,           // 性能分析，"1" 开始记录；"0" 停止并导出到 debug/profile/ 下的 Chrome trace 文件
 };
 
 enum class TouchMode
@@ -453,6 +455,10 @@ namespace asst
 {
 using TaskList = std::vector<std::string>;
 
+// 任务名在进程内的编号，由 TaskData 分配
+using TaskNameId = uint32_t;
+inline constexpr TaskNameId InvalidTaskNameId = UINT32_MAX;
+
 // 任务流程信息
 struct TaskPipelineInfo
 {
@@ -500,6 +506,7 @@ struct TaskInfo : public TaskPipelineInfo
     constexpr TaskInfo(TaskInfo&&) noexcept = default;
     constexpr TaskInfo& operator=(const TaskInfo&) = default;
     constexpr TaskInfo& operator=(TaskInfo&&) noexcept = default;
+    TaskNameId name_id = InvalidTaskNameId;                // 任务名的编号
     AlgorithmType algorithm = AlgorithmType::Invalid;      // 图像算法类型
     ProcessTaskAction action = ProcessTaskAction::Invalid; // 要进行的操作
     bool sub_error_ignored = false; // 子任务如果失败了，是否继续执行剩下的任务
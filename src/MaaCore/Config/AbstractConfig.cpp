@@ -3,6 +3,7 @@
 #include <meojson/json.hpp>
 
 #include "Utils/Demangle.hpp"
+#include "Utils/File.hpp"
 #include "Utils/Logger.hpp"
 
 bool asst::AbstractConfig::load(const std::filesystem::path& path)
@@ -15,9 +16,36 @@ bool asst::AbstractConfig::load(const std::filesystem::path& path)
     }
     m_path = path;
 
+    std::error_code size_ec;
+    std::error_code mtime_ec;
+    const auto size = std::filesystem::file_size(path, size_ec);
+    const auto mtime = std::filesystem::last_write_time(path, mtime_ec);
+    const bool stat_ok = !size_ec && !mtime_ec;
+    // 只有紧接着重复加载同一个文件时才能跳过，中间加载过别的文件（比如外服的覆盖资源）就得重新解析
+    const bool same_file = m_loaded_stamp && m_loaded_stamp->path == path;
+    if (same_file && stat_ok && m_loaded_stamp->size == size && m_loaded_stamp->mtime == mtime) {
+        Log.info(class_name, "unchanged, skip", path);
+        return true;
+    }
+
     LogTraceScope(class_name + " :: " + __FUNCTION__);
 
-    auto ret = json::open(path, true);
+    auto content = utils::read_file<std::string>(path);
+    const size_t hash = std::hash<std::string> {}(content);
+    if (same_file && m_loaded_stamp->hash == hash) {
+        // 内容没变，只是被重新写了一遍（例如 OTA）
+        Log.info(class_name, "content unchanged, skip", path);
+        m_loaded_stamp->size = size;
+        m_loaded_stamp->mtime = mtime;
+        return true;
+    }
+    m_loaded_stamp.reset();
+
+    // 与 json::open 一致，跳过 BOM
+    if (content.starts_with("\xEF\xBB\xBF")) {
+        content.erase(0, 3);
+    }
+    auto ret = json::parse(content);
     if (!ret) {
         Log.error("Json open failed", path);
         Log.info(path.lexically_relative(UserDir.get()));
@@ -26,12 +54,13 @@ bool asst::AbstractConfig::load(const std::filesystem::path& path)
 
     const auto& root = ret.value();
 
+    bool parsed = false;
 #ifdef ASST_DEBUG
     // 不捕获异常，可以通过堆栈更直观的看到资源存在的问题
-    return parse(root);
+    parsed = parse(root);
 #else
     try {
-        return parse(root);
+        parsed = parse(root);
     }
     catch (const json::exception& e) {
         Log.error("Json parse failed", path, e.what());
@@ -42,4 +71,8 @@ bool asst::AbstractConfig::load(const std::filesystem::path& path)
         return false;
     }
 #endif
+    if (parsed && stat_ok) {
+        m_loaded_stamp = FileStamp { .path = path, .size = size, .mtime = mtime, .hash = hash };
+    }
+    return parsed;
 }
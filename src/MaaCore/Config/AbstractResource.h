@@ -1,6 +1,8 @@
 #pragma once
 
 #include <filesystem>
+#include <optional>
+
 #include <meojson/json.hpp>
 
 #include "Utils/SingletonHolder.hpp"
@@ -22,5 +24,16 @@ public:
 
 protected:
     AbstractResource() = default;
+
+    // 最近一次成功加载的文件的指纹，再次加载同一个文件时用来判断内容是否有变化
+    struct FileStamp
+    {
+        std::filesystem::path path;
+        uintmax_t size = 0;
+        std::filesystem::file_time_type mtime;
+        size_t hash = 0;
+    };
+
+    std::optional<FileStamp> m_loaded_stamp;
 };
 }
@@ -1,9 +1,15 @@
 #include "AvatarCacheManager.h"
 
+#include <bit>
+#include <climits>
+
+#include "Utils/NoWarningCV.h"
+
 #include "../TaskData.h"
 #include "BattleDataConfig.h"
 #include "Utils/ImageIo.hpp"
 #include "Utils/Logger.hpp"
+#include "Utils/Ranges.hpp"
 
 bool asst::AvatarCacheManager::load(const std::filesystem::path& path)
 {
@@ -47,6 +53,7 @@ const asst::AvatarCacheManager::AvatarsMap& asst::AvatarCacheManager::get_avatar
 void asst::AvatarCacheManager::remove_avatars(battle::Role role)
 {
     m_avatars.erase(role);
+    m_hashes.erase(role);
 }
 
 void asst::AvatarCacheManager::set_avatar(
@@ -60,9 +67,12 @@ void asst::AvatarCacheManager::set_avatar(
 
     if (overlay) {
         m_avatars[role].insert_or_assign(name, avatar);
+        m_hashes[role].insert_or_assign(name, avatar_hash(avatar));
     }
     else {
-        m_avatars[role].try_emplace(name, avatar);
+        if (m_avatars[role].try_emplace(name, avatar).second) {
+            m_hashes[role].insert_or_assign(name, avatar_hash(avatar));
+        }
         return;
     }
 
@@ -107,7 +117,71 @@ void asst::AvatarCacheManager::_load(LoadItem waiting_to_load)
                 continue;
             }
 
+            m_hashes[role].insert_or_assign(name, avatar_hash(avatar));
             m_avatars[role].insert_or_assign(name, std::move(avatar));
         }
     }
 }
+
+std::vector<std::string>
+    asst::AvatarCacheManager::nearest_avatars(battle::Role role, const cv::Mat& avatar, size_t top_k)
+{
+    auto iter = m_hashes.find(role);
+    if (iter == m_hashes.end() || iter->second.empty() || avatar.empty()) {
+        return {};
+    }
+
+    const AvatarHash hash = avatar_hash(avatar);
+    std::vector<std::pair<int, const std::string*>> dists;
+    dists.reserve(iter->second.size());
+    for (const auto& [name, cached_hash] : iter->second) {
+        int dist = 0;
+        for (size_t i = 0; i < hash.size(); ++i) {
+            dist += std::popcount(hash[i] ^ cached_hash[i]);
+        }
+        dists.emplace_back(dist, &name);
+    }
+
+    const size_t count = std::min(top_k, dists.size());
+    // 距离一样时按名字排，保证每次结果一致
+    auto comp = [](const auto& lhs, const auto& rhs) {
+        return lhs.first == rhs.first ? *lhs.second < *rhs.second : lhs.first < rhs.first;
+    };
+    ranges::partial_sort(dists, dists.begin() + count, comp);
+
+    std::vector<std::string> result;
+    result.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        result.emplace_back(*dists[i].second);
+    }
+    return result;
+}
+
+asst::AvatarCacheManager::AvatarHash asst::AvatarCacheManager::avatar_hash(const cv::Mat& avatar)
+{
+    static constexpr int HashSize = 16;
+    static_assert(HashSize * HashSize == sizeof(AvatarHash) * CHAR_BIT);
+
+    cv::Mat gray;
+    if (avatar.channels() == 3) {
+        cv::cvtColor(avatar, gray, cv::COLOR_BGR2GRAY);
+    }
+    else {
+        gray = avatar;
+    }
+    // 多一列，每个像素和右边的比
+    cv::Mat resized;
+    cv::resize(gray, resized, cv::Size(HashSize + 1, HashSize), 0, 0, cv::INTER_AREA);
+
+    AvatarHash hash {};
+    for (int y = 0; y < HashSize; ++y) {
+        const uchar* row = resized.ptr<uchar>(y);
+        for (int x = 0; x < HashSize; ++x) {
+            if (row[x] > row[x + 1]) {
+                const int i = y * HashSize + x;
+                hash[i / 64] |= 1ULL << (63 - i % 64);
+            }
+        }
+    }
+    return hash;
+}
@@ -3,6 +3,7 @@
 #pragma once
 #include "Config/AbstractResource.h"
 
+#include <array>
 #include <future>
 #include <unordered_map>
 
@@ -17,6 +18,8 @@ class AvatarCacheManager final : public SingletonHolder<AvatarCacheManager>, pub
 {
 public:
     using AvatarsMap = std::unordered_map<std::string, cv::Mat>;
+    // 16x16 的差值哈希，只看相邻像素谁亮，冷却时头像整体变暗也差不太多
+    using AvatarHash = std::array<uint64_t, 4>;
     inline static const std::string CacheExtension = ".png";
 
 public:
@@ -28,6 +31,11 @@ public:
     void remove_avatars(battle::Role role);
     void set_avatar(const std::string& name, battle::Role role, const cv::Mat& avatar, bool overlay = true);
 
+    // 该职业的缓存头像中和 avatar 哈希最接近的 top_k 个，按距离从近到远，只是粗筛，还得再模板匹配确认
+    std::vector<std::string> nearest_avatars(battle::Role role, const cv::Mat& avatar, size_t top_k);
+
+    static AvatarHash avatar_hash(const cv::Mat& avatar);
+
 private:
     using LoadItem = std::unordered_map<battle::Role, std::unordered_map<std::string, std::filesystem::path>>;
     void _load(LoadItem waiting_to_load);
@@ -37,6 +45,8 @@ private:
     std::mutex m_load_mutex;
 
     std::unordered_map<battle::Role, std::unordered_map<std::string, cv::Mat>> m_avatars;
+    // 和 m_avatars 一一对应，头像放进缓存的时候就算好
+    std::unordered_map<battle::Role, std::unordered_map<std::string, AvatarHash>> m_hashes;
 };
 
 inline static auto& AvatarCache = AvatarCacheManager::get_instance();
@@ -43,6 +43,8 @@ bool asst::CopilotConfig::parse_magic_code(const std::string& copilot_magic_code
 void asst::CopilotConfig::clear()
 {
     m_data = decltype(m_data)();
+    // 数据可能来自神秘代码而不是文件，之后再加载同一个文件时不能跳过
+    m_loaded_stamp.reset();
 }
 
 bool asst::CopilotConfig::parse(const json::value& json)
@@ -3,8 +3,76 @@
 #include <meojson/json.hpp>
 
 #include "Utils/Logger.hpp"
+#include "Utils/StringMisc.hpp"
+
+namespace
+{
+// 一个 utf-8 字符的字节数，非法的首字节按单字节处理
+size_t utf8_char_length(unsigned char lead) noexcept
+{
+    if (lead < 0x80) {
+        return 1;
+    }
+    if ((lead >> 5) == 0x06) {
+        return 2;
+    }
+    if ((lead >> 4) == 0x0E) {
+        return 3;
+    }
+    if ((lead >> 3) == 0x1E) {
+        return 4;
+    }
+    return 1;
+}
+
+// 直接把 utf-8 字节序列打包成 key，不需要真正解码
+char32_t pack_utf8_char(std::string_view ch) noexcept
+{
+    char32_t key = 0;
+    for (char c : ch) {
+        key = (key << 8) | static_cast<unsigned char>(c);
+    }
+    return key;
+}
+}
 
 std::string asst::OcrConfig::process_equivalence_class(const std::string& str) const
+{
+    if (!m_eq_compiled) {
+        return process_equivalence_class_slow(str);
+    }
+    if (m_eq_codepoint_table.empty() && ranges::none_of(m_eq_ascii_table, [](const auto& x) { return x.has_value(); })) {
+        return str;
+    }
+
+    std::string result;
+    result.reserve(str.size());
+    for (size_t pos = 0; pos < str.size();) {
+        const auto lead = static_cast<unsigned char>(str[pos]);
+        const size_t len = std::min(utf8_char_length(lead), str.size() - pos);
+        const std::string* replaced = nullptr;
+        if (lead < 0x80) {
+            if (const auto& opt = m_eq_ascii_table[lead]) {
+                replaced = &*opt;
+            }
+        }
+        else if (auto iter = m_eq_codepoint_table.find(pack_utf8_char(std::string_view(str).substr(pos, len)));
+                 iter != m_eq_codepoint_table.end()) {
+            replaced = &iter->second;
+        }
+
+        if (replaced) {
+            result += *replaced;
+        }
+        else {
+            result.append(str, pos, len);
+        }
+        pos += len;
+    }
+    return result;
+}
+
+std::string asst::OcrConfig::process_equivalence_class_slow(const std::string& str) const
 {
     std::string result = str;
     for (const auto& eq_class : m_eq_classes) {
@@ -15,11 +83,102 @@ std::string asst::OcrConfig::process_equivalence_class(const std::string& str) c
     return result;
 }
 
+void asst::OcrConfig::compile_eq_classes()
+{
+    m_eq_ascii_table.fill(std::nullopt);
+    m_eq_codepoint_table.clear();
+
+    // 被替换的元素都是单个字符时，utf-8 的自同步性保证逐个等价类 replace_all 等价于逐字符查表，
+    // 等价类之间的连锁替换（前一个类的结果又被后一个类替换）由 process_equivalence_class_slow 算出来
+    m_eq_compiled = ranges::all_of(m_eq_classes, [](const equivalence_class& eq_class) {
+        return eq_class.empty() ||
+               std::all_of(eq_class.begin() + 1, eq_class.end(), [](const std::string& elem) {
+                   return !elem.empty() && utf8_char_length(static_cast<unsigned char>(elem.front())) == elem.size();
+               });
+    });
+    if (!m_eq_compiled) {
+        Log.info(__FUNCTION__, "multi-char element in equivalence classes, fallback to replace_all");
+        return;
+    }
+
+    for (const auto& eq_class : m_eq_classes) {
+        if (eq_class.size() <= 1) {
+            continue;
+        }
+        for (auto iter = eq_class.begin() + 1; iter != eq_class.end(); ++iter) {
+            const std::string& elem = *iter;
+            std::string replaced = process_equivalence_class_slow(elem);
+            if (replaced == elem) {
+                continue;
+            }
+            const auto lead = static_cast<unsigned char>(elem.front());
+            if (lead < 0x80) {
+                m_eq_ascii_table[lead] = std::move(replaced);
+            }
+            else {
+                m_eq_codepoint_table.insert_or_assign(pack_utf8_char(elem), std::move(replaced));
+            }
+        }
+    }
+}
+
+std::shared_ptr<const asst::OcrReplaceRegex> asst::OcrConfig::get_replace_regex(const std::string& raw_pattern)
+{
+    {
+        std::shared_lock lock(m_replace_mutex);
+        if (auto iter = m_replace_regexes.find(raw_pattern); iter != m_replace_regexes.end()) {
+            return iter->second;
+        }
+    }
+
+    std::shared_ptr<OcrReplaceRegex> compiled = std::make_shared<OcrReplaceRegex>();
+    compiled->pattern = expand_equivalence_regex(raw_pattern);
+    if (!compiled->pattern.empty() && compiled->pattern.find_first_of(R"(\^$.|?*+()[]{})") == std::string::npos) {
+        compiled->literal = compiled->pattern;
+    }
+    try {
+        compiled->regex = std::regex(compiled->pattern, std::regex::ECMAScript | std::regex::optimize);
+    }
+    catch (const std::regex_error& e) {
+        Log.error(__FUNCTION__, "invalid regex:", raw_pattern, ":", e.what());
+        compiled = nullptr;
+    }
+
+    std::unique_lock lock(m_replace_mutex);
+    return m_replace_regexes.try_emplace(raw_pattern, std::move(compiled)).first->second;
+}
+
+std::string asst::OcrConfig::expand_equivalence_regex(const std::string& raw_pattern) const
+{
+    std::string result = raw_pattern;
+    for (const auto& eq_class : m_eq_classes) {
+        if (eq_class.size() <= 1) {
+            continue;
+        }
+
+        // eq_class: [s, S] -> regex: "(?:s|S)"
+        std::string eq_classes_regex = "(?:";
+        for (const auto& elem : eq_class) {
+            (eq_classes_regex += elem) += '|';
+        }
+        eq_classes_regex.pop_back();
+        eq_classes_regex += ')';
+        ranges::for_each(eq_class, [&](std::string_view elem) {
+            utils::string_replace_all_in_place(result, elem, eq_classes_regex);
+        });
+    }
+    return result;
+}
+
 bool asst::OcrConfig::parse(const json::value& json)
 {
     LogTraceFunction;
 
     m_eq_classes.clear();
+    {
+        std::unique_lock lock(m_replace_mutex);
+        m_replace_regexes.clear();
+    }
 
     for (const json::value& eq_class : json.at("equivalence_classes").as_array()) {
         equivalence_class eq_class_tmp;
@@ -28,5 +187,6 @@ bool asst::OcrConfig::parse(const json::value& json)
         }
         m_eq_classes.emplace_back(std::move(eq_class_tmp));
     }
+    compile_eq_classes();
     return true;
 }
@@ -4,8 +4,14 @@
 
 #include "Utils/Ranges.hpp"
 #include <algorithm>
+#include <array>
+#include <memory>
 #include <numeric>
+#include <optional>
+#include <regex>
+#include <shared_mutex>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -13,20 +19,45 @@
 
 namespace asst
 {
+// ocrReplace 中的一条规则，按等价类展开后编译好的正则
+struct OcrReplaceRegex
+{
+    std::string pattern;                // 按等价类展开后的正则
+    std::optional<std::string> literal; // 没有正则元字符时直接按字符串查找，不走 std::regex
+    std::regex regex;
+};
+
 class OcrConfig final : public SingletonHolder<OcrConfig>, public AbstractConfig
 {
 public:
     virtual ~OcrConfig() override = default;
 
+    // 把 str 中的字符替换为所在等价类的第一个元素
     std::string process_equivalence_class(const std::string& str) const;
 
     auto get_eq_classes() const noexcept { return m_eq_classes; }
 
+    // 编译结果会被缓存，重新加载等价类时清空；正则非法时返回 nullptr
+    std::shared_ptr<const OcrReplaceRegex> get_replace_regex(const std::string& raw_pattern);
+
 protected:
     virtual bool parse(const json::value& json) override;
 
+    std::string expand_equivalence_regex(const std::string& raw_pattern) const;
+    // 逐个等价类做 replace_all，仅在等价类中有多字符元素时使用
+    std::string process_equivalence_class_slow(const std::string& str) const;
+    void compile_eq_classes();
+
     using equivalence_class = std::vector<std::string>;
 
     std::vector<equivalence_class> m_eq_classes;
+
+    // 等价类元素都是单个字符时，编译成 字符 -> 替换结果 的表，一遍扫描完成归一化
+    bool m_eq_compiled = true;
+    std::array<std::optional<std::string>, 128> m_eq_ascii_table;
+    std::unordered_map<char32_t, std::string> m_eq_codepoint_table;
+
+    std::shared_mutex m_replace_mutex;
+    std::unordered_map<std::string, std::shared_ptr<const OcrReplaceRegex>> m_replace_regexes;
 };
 } // namespace asst
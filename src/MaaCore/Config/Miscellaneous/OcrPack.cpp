@@ -9,6 +9,8 @@ ASST_SUPPRESS_CV_WARNINGS_START
 #include "fastdeploy/vision/ocr/ppocr/recognizer.h"
 ASST_SUPPRESS_CV_WARNINGS_END
 
+#include "Config/OnnxSessions.h"
+#include "Utils/CacheFile.hpp"
 #include "Utils/Demangle.hpp"
 #include "Utils/File.hpp"
 #include "Utils/Logger.hpp"
@@ -71,6 +73,7 @@ bool asst::OcrPack::load(const std::filesystem::path& path)
 
 asst::OcrPack::ResultsVec asst::OcrPack::recognize(const cv::Mat& image, bool without_det)
 {
+    ProfileScope(without_det ? "OcrPack::recognize (rec)" : "OcrPack::recognize (det+rec)", "ocr");
     if (!check_and_load()) {
         Log.error(__FUNCTION__, "check_and_load failed");
         return {};
@@ -150,23 +153,58 @@ bool asst::OcrPack::check_and_load()
         option.UseGpu(*m_gpu_id);
     }
 
-    auto det_model = asst::utils::read_file<std::string>(m_det_model_path);
-    option.SetModelBuffer(det_model.data(), det_model.size(), nullptr, 0, fastdeploy::ModelFormat::ONNX);
-    m_det = std::make_unique<fastdeploy::vision::ocr::DBDetector>(
-        "dummy.onnx",
-        std::string(),
-        option,
-        fastdeploy::ModelFormat::ONNX);
+    // 缓存的是已经优化过的图，不需要再跑一遍优化
+    auto set_model_option = [&](const std::string& model, bool optimized, const std::filesystem::path& save_path) {
+        option.SetModelBuffer(model.data(), model.size(), nullptr, 0, fastdeploy::ModelFormat::ONNX);
+        option.ort_option.graph_optimization_level = optimized ? 0 /* ORT_DISABLE_ALL */ : -1;
+        option.ort_option.optimized_model_filepath =
+            save_path.empty() ? std::string() : utils::path_to_crt_string(save_path);
+    };
+
+    auto load_det = [&]() {
+        bool optimized = false;
+        std::filesystem::path save_path;
+        std::filesystem::path cache_path;
+        auto model = read_model(m_det_model_path, optimized, save_path, cache_path);
+        set_model_option(model, optimized, save_path);
+        m_det = std::make_unique<fastdeploy::vision::ocr::DBDetector>(
+            "dummy.onnx",
+            std::string(),
+            option,
+            fastdeploy::ModelFormat::ONNX);
+        bool inited = m_det && m_det->Initialized();
+        commit_model_cache(save_path, cache_path, inited);
+        return inited || !optimized;
+    };
+    // 缓存坏了的话删掉，用原模型再来一次，不然就一直用不了了
+    if (!load_det()) {
+        Log.warn(__FUNCTION__, "broken optimized det model cache, retry with original model");
+        discard_model_cache(m_det_model_path);
+        load_det();
+    }
 
-    auto rec_model = asst::utils::read_file<std::string>(m_rec_model_path);
     std::string rec_label = asst::utils::read_file<std::string>(m_rec_label_path);
-    option.SetModelBuffer(rec_model.data(), rec_model.size(), nullptr, 0, fastdeploy::ModelFormat::ONNX);
-    m_rec = std::make_unique<fastdeploy::vision::ocr::Recognizer>(
-        "dummy.onnx",
-        std::string(),
-        rec_label,
-        option,
-        fastdeploy::ModelFormat::ONNX);
+    auto load_rec = [&]() {
+        bool optimized = false;
+        std::filesystem::path save_path;
+        std::filesystem::path cache_path;
+        auto model = read_model(m_rec_model_path, optimized, save_path, cache_path);
+        set_model_option(model, optimized, save_path);
+        m_rec = std::make_unique<fastdeploy::vision::ocr::Recognizer>(
+            "dummy.onnx",
+            std::string(),
+            rec_label,
+            option,
+            fastdeploy::ModelFormat::ONNX);
+        bool inited = m_rec && m_rec->Initialized();
+        commit_model_cache(save_path, cache_path, inited);
+        return inited || !optimized;
+    };
+    if (!load_rec()) {
+        Log.warn(__FUNCTION__, "broken optimized rec model cache, retry with original model");
+        discard_model_cache(m_rec_model_path);
+        load_rec();
+    }
 
     if (m_det && m_rec) {
         m_ocr = std::make_unique<fastdeploy::pipeline::PPOCRv3>(m_det.get(), m_rec.get());
@@ -180,3 +218,67 @@ bool asst::OcrPack::check_and_load()
 
     return det_inited && rec_inited && ocr_inited;
 }
+
+std::string asst::OcrPack::read_model(
+    const std::filesystem::path& model_path,
+    bool& optimized,
+    std::filesystem::path& save_path,
+    std::filesystem::path& cache_path) const
+{
+    optimized = false;
+    save_path.clear();
+    cache_path.clear();
+
+    auto model = asst::utils::read_file<std::string>(model_path);
+    // GPU 的 EP 会把优化结果和设备绑定，只缓存 CPU 的
+    if (m_gpu_id) {
+        return model;
+    }
+
+    cache_path = OnnxSessions::optimized_model_cache_path(model_path, model);
+    if (std::filesystem::exists(cache_path)) {
+        auto cached = asst::utils::read_file<std::string>(cache_path);
+        if (!cached.empty()) {
+            Log.info(__FUNCTION__, "load optimized model from cache", cache_path.lexically_relative(UserDir.get()));
+            optimized = true;
+            return cached;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(cache_path.parent_path(), ec);
+    utils::remove_stale_temp_files(cache_path.parent_path());
+    // 先写到临时文件，初始化成功后再改名，避免中途退出留下半个文件
+    save_path = utils::unique_temp_path(cache_path);
+    return model;
+}
+
+void asst::OcrPack::commit_model_cache(
+    const std::filesystem::path& save_path,
+    const std::filesystem::path& cache_path,
+    bool inited)
+{
+    if (save_path.empty()) {
+        return;
+    }
+    std::error_code ec;
+    if (!inited || !std::filesystem::exists(save_path, ec)) {
+        std::filesystem::remove(save_path, ec);
+        return;
+    }
+    std::filesystem::rename(save_path, cache_path, ec);
+    if (ec) {
+        Log.warn(__FUNCTION__, "failed to save optimized model cache", ec.message());
+        std::filesystem::remove(save_path, ec);
+        return;
+    }
+    Log.info(__FUNCTION__, "optimized model saved", cache_path.lexically_relative(UserDir.get()));
+}
+
+void asst::OcrPack::discard_model_cache(const std::filesystem::path& model_path) const
+{
+    const auto model = asst::utils::read_file<std::string>(model_path);
+    const auto cache_path = OnnxSessions::optimized_model_cache_path(model_path, model);
+    std::error_code ec;
+    std::filesystem::remove(cache_path, ec);
+}
@@ -50,6 +50,19 @@ protected:
     OcrPack();
 
     bool check_and_load();
+    // 读取模型，CPU 模式下优先使用 ORT 优化后的缓存
+    // 返回值为模型内容；若缓存不存在，save_path 为本次需要写入的临时缓存路径，成功后改名为 cache_path
+    std::string read_model(
+        const std::filesystem::path& model_path,
+        bool& optimized,
+        std::filesystem::path& save_path,
+        std::filesystem::path& cache_path) const;
+    static void commit_model_cache(
+        const std::filesystem::path& save_path,
+        const std::filesystem::path& cache_path,
+        bool inited);
+    // 缓存的优化模型初始化失败时删掉，之后的 read_model 会重新从原模型优化
+    void discard_model_cache(const std::filesystem::path& model_path) const;
 
     std::unique_ptr<fastdeploy::vision::ocr::DBDetector> m_det;
     std::unique_ptr<fastdeploy::vision::ocr::Recognizer> m_rec;
@@ -1,6 +1,7 @@
 #include "RecruitConfig.h"
 
 #include <algorithm>
+#include <numeric>
 
 #include <meojson/json.hpp>
 
@@ -54,9 +55,135 @@ bool asst::RecruitConfig::parse(const json::value& json)
     // 按干员等级排个序
     ranges::sort(m_all_opers, std::greater {}, std::mem_fn(&Recruitment::level));
 
+    if (m_all_opers.size() > MaxOpers) {
+        Log.error(__FUNCTION__, "too many operators", m_all_opers.size(), "max", MaxOpers);
+        return false;
+    }
+    m_oper_index.resize(m_all_opers.size());
+    std::iota(m_oper_index.begin(), m_oper_index.end(), 0);
+    ranges::sort(m_oper_index, std::less {}, [&](size_t pos) -> const Recruitment& { return m_all_opers[pos]; });
+    for (size_t index = 0; index < m_oper_index.size(); ++index) {
+        const Recruitment& oper = m_all_opers[m_oper_index[index]];
+        for (const std::string& tag : oper.tags) {
+            m_tag_opers[tag].set(index);
+        }
+        if (oper.level >= 0 && static_cast<size_t>(oper.level) < m_level_opers.size()) {
+            m_level_opers[oper.level].set(index);
+        }
+    }
+
     return true;
 }
 
+const asst::RecruitConfig::OperSet& asst::RecruitConfig::get_tag_opers(const TagId& tag) const noexcept
+{
+    static const OperSet empty;
+    auto iter = m_tag_opers.find(tag);
+    return iter == m_tag_opers.cend() ? empty : iter->second;
+}
+
+std::vector<asst::RecruitCombs> asst::RecruitConfig::get_all_combs(const std::vector<TagId>& tags) const
+{
+    // 结果和 tags 的顺序无关，排个序当作 key
+    std::vector<TagId> sorted_tags = tags;
+    ranges::sort(sorted_tags);
+    std::string key;
+    for (const TagId& tag : sorted_tags) {
+        key += tag;
+        key += '\n';
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(m_combs_mutex);
+        if (const auto* cached = m_combs_cache.get(key)) {
+            return *cached;
+        }
+    }
+
+    auto result = calc_all_combs(sorted_tags);
+
+    std::unique_lock<std::mutex> lock(m_combs_mutex);
+    m_combs_cache.put(key, result);
+    return result;
+}
+
+std::vector<asst::RecruitCombs> asst::RecruitConfig::calc_all_combs(const std::vector<TagId>& sorted_tags) const
+{
+    static const TagId SeniorOper = "高级资深干员";
+
+    std::vector<RecruitCombs> result;
+    const size_t tag_size = sorted_tags.size();
+    result.reserve(tag_size * (tag_size * tag_size + 5) / 6); // C(size, 3) + C(size, 2) + C(size, 1)
+
+    auto add_comb = [&](std::vector<TagId> comb_tags, OperSet opers) {
+        if (ranges::find(comb_tags, SeniorOper) == comb_tags.end()) {
+            // no senior tag, remove 6-star operators
+            opers &= ~m_level_opers[6];
+        }
+        if (opers.none()) {
+            return;
+        }
+        result.emplace_back(make_comb(std::move(comb_tags), opers));
+    };
+
+    for (size_t i = 0; i < tag_size; ++i) {
+        const OperSet& opers1 = get_tag_opers(sorted_tags[i]);
+        if (opers1.none()) [[unlikely]] {
+            continue;
+        }
+        add_comb({ sorted_tags[i] }, opers1);
+
+        for (size_t j = i + 1; j < tag_size; ++j) {
+            const OperSet opers2 = opers1 & get_tag_opers(sorted_tags[j]);
+            if (opers2.none()) [[unlikely]] {
+                continue;
+            }
+            add_comb({ sorted_tags[i], sorted_tags[j] }, opers2);
+
+            for (size_t k = j + 1; k < tag_size; ++k) {
+                const OperSet opers3 = opers2 & get_tag_opers(sorted_tags[k]);
+                if (opers3.none()) [[unlikely]] {
+                    continue;
+                }
+                add_comb({ sorted_tags[i], sorted_tags[j], sorted_tags[k] }, opers3);
+            }
+        }
+    }
+    return result;
+}
+
+asst::RecruitCombs asst::RecruitConfig::make_comb(std::vector<TagId> tags, const OperSet& opers) const
+{
+    RecruitCombs comb;
+    comb.tags = std::move(tags);
+
+    // 星级的统计直接用每个星级的掩码数一下
+    bool first_level = true;
+    size_t level_sum = 0;
+    for (size_t level = 0; level < m_level_opers.size(); ++level) {
+        const size_t count = (opers & m_level_opers[level]).count();
+        if (count == 0) {
+            continue;
+        }
+        if (first_level) {
+            comb.min_level = static_cast<int>(level);
+            first_level = false;
+        }
+        comb.max_level = static_cast<int>(level);
+        level_sum += level * count;
+    }
+    const size_t total = opers.count();
+    comb.avg_level = static_cast<double>(level_sum) / static_cast<double>(total);
+
+    comb.opers.reserve(total);
+    for (size_t index = 0; index < m_oper_index.size(); ++index) {
+        if (opers.test(index)) {
+            comb.opers.emplace_back(m_all_opers[m_oper_index[index]]);
+        }
+    }
+    return comb;
+}
+
 void asst::RecruitConfig::clear()
 {
     LogTraceFunction;
@@ -65,4 +192,10 @@ void asst::RecruitConfig::clear()
     m_all_tags.clear();
     m_all_tags_displayed.clear();
     m_all_tags_name.clear();
+
+    m_oper_index.clear();
+    m_tag_opers.clear();
+    m_level_opers.fill(OperSet {});
+    std::unique_lock<std::mutex> lock(m_combs_mutex);
+    m_combs_cache.clear();
 }
@@ -2,8 +2,12 @@
 
 #include "Config/AbstractConfig.h"
 
+#include "Utils/LruCache.hpp"
 #include "Utils/Ranges.hpp"
 #include <algorithm>
+#include <array>
+#include <bitset>
+#include <mutex>
 #include <numeric>
 #include <string>
 #include <unordered_set>
@@ -49,6 +53,16 @@ struct Recruitment
     }
 };
 
+// 公开招募的干员组合
+struct RecruitCombs
+{
+    std::vector<std::string> tags;  // tag id，升序
+    std::vector<Recruitment> opers; // 按 Recruitment 的顺序升序
+    int max_level = 0;
+    int min_level = 0;
+    double avg_level = 0;
+};
+
 // 选择额外 Tags 的模式
 enum class ExtraTagsMode
 {
@@ -61,6 +75,9 @@ class RecruitConfig final : public SingletonHolder<RecruitConfig>, public Abstra
 {
 public:
     using TagId = std::string;
+    // 每个干员在公招计算中有一个固定的下标，干员集合就是一个按下标的 bitset
+    static constexpr size_t MaxOpers = 512;
+    using OperSet = std::bitset<MaxOpers>;
 
 public:
     static constexpr bool is_valid_extra_tags_mode(ExtraTagsMode mode)
@@ -82,70 +99,32 @@ public:
     // 根据 外文/中文tag 名称查找 中文tag id
     std::string find_tag_id(const std::string& name) const noexcept;
 
+    // 有这个 tag 的所有干员
+    const OperSet& get_tag_opers(const TagId& tag) const noexcept;
+    // 所有一到三个 tag 的组合及可能出的干员，不含空集；组合里没有高级资深干员时不含六星
+    // 同一组 tags 的结果会缓存下来
+    std::vector<RecruitCombs> get_all_combs(const std::vector<TagId>& tags) const;
+
 protected:
     virtual bool parse(const json::value& json) override;
 
     void clear();
 
+    RecruitCombs make_comb(std::vector<TagId> tags, const OperSet& opers) const;
+    std::vector<RecruitCombs> calc_all_combs(const std::vector<TagId>& sorted_tags) const;
+
     std::unordered_set<std::string> m_all_tags;
     std::unordered_set<std::string> m_all_tags_displayed;
     std::vector<Recruitment> m_all_opers;
     std::unordered_map<TagId, std::string> m_all_tags_name; // <中文tag, 中文/外文tag>
-};
 
-// 公开招募的干员组合
-struct RecruitCombs
-{
-    // TODO: using vector here can be expensive
-    std::vector<RecruitConfig::TagId> tags;
-    std::vector<Recruitment> opers;
-    int max_level = 0;
-    int min_level = 0;
-    double avg_level = 0;
+    // 干员下标按 Recruitment 升序分配，这样从集合展开出来的干员列表天然有序
+    std::vector<size_t> m_oper_index;               // 干员下标 -> 在 m_all_opers 中的位置
+    std::unordered_map<TagId, OperSet> m_tag_opers; // tag -> 有这个 tag 的干员
+    std::array<OperSet, 7> m_level_opers;           // 星级 -> 这个星级的干员
 
-    void update_attributes()
-    {
-        min_level = std::transform_reduce(
-            opers.cbegin(),
-            opers.cend(),
-            7,
-            [](int a, int b) -> int { return (std::min)(a, b); },
-            std::mem_fn(&Recruitment::level));
-
-        max_level = std::transform_reduce(
-            opers.cbegin(),
-            opers.cend(),
-            0,
-            [](int a, int b) -> int { return (std::max)(a, b); },
-            std::mem_fn(&Recruitment::level));
-
-        avg_level = std::transform_reduce(
-                        opers.cbegin(),
-                        opers.cend(),
-                        0.,
-                        std::plus<double> {},
-                        std::mem_fn(&Recruitment::level)) /
-                    static_cast<double>(opers.size());
-    }
-
-    // intersection of two recruit combs
-    friend RecruitCombs operator*(RecruitCombs& lhs, RecruitCombs& rhs)
-    {
-        ranges::sort(lhs.tags);
-        ranges::sort(lhs.opers);
-        ranges::sort(rhs.tags);
-        ranges::sort(rhs.opers);
-
-        RecruitCombs result;
-
-        ranges::set_union(lhs.tags, rhs.tags, std::back_inserter(result.tags));
-
-        ranges::set_intersection(lhs.opers, rhs.opers, std::back_inserter(result.opers));
-
-        result.update_attributes();
-
-        return result;
-    }
+    mutable std::mutex m_combs_mutex;
+    mutable LruCache<std::string, std::vector<RecruitCombs>> m_combs_cache { 64 };
 };
 
 inline static auto& RecruitData = RecruitConfig::get_instance();
@@ -13,6 +13,8 @@ using namespace asst::battle::sss;
 void asst::SSSCopilotConfig::clear()
 {
     m_data = decltype(m_data)();
+    // 数据可能来自神秘代码而不是文件，之后再加载同一个文件时不能跳过
+    m_loaded_stamp.reset();
 }
 
 bool asst::SSSCopilotConfig::parse(const json::value& json)
@@ -20,6 +20,7 @@ ASST_SUPPRESS_CV_WARNINGS_START
 ASST_SUPPRESS_CV_WARNINGS_END
 
 #include "Utils/Logger.hpp"
+#include "Utils/Ranges.hpp"
 
 bool asst::TilePack::parse(const json::value& json)
 {
@@ -38,11 +39,153 @@ bool asst::TilePack::parse(const json::value& json)
         //     Log.error("file not exists", filepath);
         //     return false;
         // }
+        const size_t index = m_summarize.size();
+        const auto fields = fields_of(level_key);
+        for (size_t i = 0; i < FieldCount; ++i) {
+            auto& field_index = m_field_indices[i];
+            if (fields[i]->empty()) {
+                field_index.empty.emplace_back(index);
+            }
+            else {
+                field_index.indices[*fields[i]].emplace_back(index);
+            }
+        }
         m_summarize.emplace_back(std::move(level_key), std::move(filepath));
     }
+
+    std::unique_lock<std::mutex> lock(m_cache_mutex);
+    m_level_cache.clear();
+    m_result_cache.clear();
     return true;
 }
 
+std::optional<asst::TilePack::LazyMap::value_type> asst::TilePack::find(const std::string& any_key) const
+{
+    auto index_opt = find_index(any_key);
+    if (!index_opt) {
+        return std::nullopt;
+    }
+    return m_summarize[*index_opt];
+}
+
+std::optional<asst::TilePack::LazyMap::value_type> asst::TilePack::find(const LevelKey& key) const
+{
+    auto index_opt = find_index(key);
+    if (!index_opt) {
+        return std::nullopt;
+    }
+    return m_summarize[*index_opt];
+}
+
+std::optional<size_t> asst::TilePack::find_index(const std::string& any_key) const
+{
+    if (any_key.empty()) {
+        return std::nullopt;
+    }
+
+    // 任意一个字段相等或为空即可，各个候选列表都是升序的，取最小的下标
+    std::optional<size_t> result;
+    auto update = [&](const std::vector<size_t>& candidates) {
+        if (!candidates.empty() && (!result || candidates.front() < *result)) {
+            result = candidates.front();
+        }
+    };
+    for (const auto& field_index : m_field_indices) {
+        if (auto iter = field_index.indices.find(any_key); iter != field_index.indices.end()) {
+            update(iter->second);
+        }
+        update(field_index.empty);
+    }
+    return result;
+}
+
+std::optional<size_t> asst::TilePack::find_index(const LevelKey& key) const
+{
+    // 随便挑一个非空字段缩小范围，再按完整的规则逐个比较
+    const auto fields = fields_of(key);
+    auto field_iter = ranges::find_if(fields, [](const std::string* field) { return !field->empty(); });
+    if (field_iter == fields.end()) {
+        return m_summarize.empty() ? std::nullopt : std::make_optional<size_t>(0);
+    }
+    const auto& field_index = m_field_indices[std::distance(fields.begin(), field_iter)];
+
+    static const std::vector<size_t> EmptyIndices;
+    const auto matched_iter = field_index.indices.find(**field_iter);
+    const auto& matched = matched_iter == field_index.indices.end() ? EmptyIndices : matched_iter->second;
+    const auto& wildcard = field_index.empty;
+
+    // 两个升序列表归并
+    auto lhs = matched.begin();
+    auto rhs = wildcard.begin();
+    while (lhs != matched.end() || rhs != wildcard.end()) {
+        size_t index = 0;
+        if (rhs == wildcard.end() || (lhs != matched.end() && *lhs < *rhs)) {
+            index = *lhs++;
+        }
+        else {
+            index = *rhs++;
+        }
+        if (m_summarize[index].first == key) {
+            return index;
+        }
+    }
+    return std::nullopt;
+}
+
+std::shared_ptr<const Map::Level> asst::TilePack::get_level(size_t index)
+{
+    {
+        std::unique_lock<std::mutex> lock(m_cache_mutex);
+        if (auto* cached = m_level_cache.get(index)) {
+            return *cached;
+        }
+    }
+
+    // 解析放在锁外面，不同关卡可以同时解析
+    const auto& path = m_summarize[index].second;
+    auto json_opt = json::open(path);
+    if (!json_opt) {
+        Log.error("failed to open level file", path);
+        return nullptr;
+    }
+    std::shared_ptr<const Map::Level> level_ptr;
+    try {
+        level_ptr = std::make_shared<const Map::Level>(*json_opt);
+    }
+    catch (const json::exception& e) {
+        Log.error("failed to parse level file", path, e.what());
+        return nullptr;
+    }
+
+    std::unique_lock<std::mutex> lock(m_cache_mutex);
+    m_level_cache.put(index, level_ptr);
+    return level_ptr;
+}
+
+asst::TilePack::result_type asst::TilePack::calc_by_index(size_t index, double shift_x, double shift_y)
+{
+    const ResultKey result_key { .index = index, .shift_x = shift_x, .shift_y = shift_y };
+    {
+        std::unique_lock<std::mutex> lock(m_cache_mutex);
+        if (auto* cached = m_result_cache.get(result_key)) {
+            return *cached;
+        }
+    }
+
+    auto level_ptr = get_level(index);
+    if (!level_ptr) {
+        return {};
+    }
+    auto result = calc_(*level_ptr, shift_x, shift_y);
+    if (result.normal_tile_info.empty()) {
+        return result;
+    }
+
+    std::unique_lock<std::mutex> lock(m_cache_mutex);
+    m_result_cache.put(result_key, result);
+    return result;
+}
+
 bool proc_data(
     std::unordered_map<asst::Point, asst::TilePack::TileInfo>& dst,
     asst::Point loc,
@@ -3,6 +3,11 @@
 #include "Common/AsstBattleDef.h"
 #include "Common/AsstTypes.h"
 #include "Config/AbstractConfig.h"
+#include "Utils/LruCache.hpp"
+
+#include <array>
+#include <memory>
+#include <mutex>
 
 ASST_SUPPRESS_CV_WARNINGS_START
 #include <Arknights-Tile-Pos/TileDef.hpp>
@@ -64,40 +69,34 @@ public:
 public:
     virtual ~TilePack() override = default;
 
-    template <typename KeyT>
-    std::optional<LazyMap::value_type> find(const KeyT& key) const
-    {
-        for (const auto& pair : m_summarize) {
-            if (pair.first == key) {
-                return pair;
-            }
-        }
-        return std::nullopt;
-    }
+    // 与 LevelKey::operator== 的语义一致：任意一边为空的字段视为匹配，有多个匹配时取第一个
+    std::optional<LazyMap::value_type> find(const std::string& any_key) const;
+    std::optional<LazyMap::value_type> find(const LevelKey& key) const;
 
     template <typename KeyT>
     std::optional<Map::Level> static find_level(const KeyT& key)
     {
-        auto file_opt = TilePack::get_instance().find(key);
-        if (!file_opt) {
+        auto& ins = TilePack::get_instance();
+        auto index_opt = ins.find_index(key);
+        if (!index_opt) {
             return {};
         }
-        auto json_opt = json::open(file_opt->second);
-        if (!json_opt) {
+        auto level_ptr = ins.get_level(*index_opt);
+        if (!level_ptr) {
             return {};
         }
-        return Map::Level(*json_opt);
+        return *level_ptr;
     }
 
     template <typename KeyT>
     result_type static calc(const KeyT& key, double shift_x = 0, double shift_y = 0)
     {
-        auto level_opt = find_level(key);
-        if (!level_opt) {
+        auto& ins = TilePack::get_instance();
+        auto index_opt = ins.find_index(key);
+        if (!index_opt) {
             return {};
         }
-
-        return calc_(*level_opt, shift_x, shift_y);
+        return ins.calc_by_index(*index_opt, shift_x, shift_y);
     }
 
     result_type static calc(const Map::Level& data, double shift_x = 0, double shift_y = 0)
@@ -109,8 +108,57 @@ protected:
     bool parse(const json::value& json) override;
 
 private:
+    // 按 stageId / code / levelId / name 分别建的索引，值为 m_summarize 中的下标（升序）
+    struct FieldIndex
+    {
+        std::unordered_map<std::string, std::vector<size_t>> indices;
+        std::vector<size_t> empty; // 该字段为空的条目，可以匹配任何值
+    };
+
+    struct ResultKey
+    {
+        size_t index = 0;
+        double shift_x = 0;
+        double shift_y = 0;
+
+        bool operator==(const ResultKey&) const noexcept = default;
+    };
+
+    struct ResultKeyHash
+    {
+        size_t operator()(const ResultKey& key) const noexcept
+        {
+            size_t seed = std::hash<size_t> {}(key.index);
+            seed ^= std::hash<double> {}(key.shift_x) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            seed ^= std::hash<double> {}(key.shift_y) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            return seed;
+        }
+    };
+
+    static constexpr size_t FieldCount = 4;
+    static constexpr size_t LevelCacheSize = 8;
+    static constexpr size_t ResultCacheSize = 32;
+
+    static std::array<const std::string*, FieldCount> fields_of(const LevelKey& key) noexcept
+    {
+        return { &key.stageId, &key.code, &key.levelId, &key.name };
+    }
+
+    std::optional<size_t> find_index(const std::string& any_key) const;
+    std::optional<size_t> find_index(const LevelKey& key) const;
+
+    // 解析过的关卡文件会缓存下来，战斗中反复计算时不用再读一遍 json
+    std::shared_ptr<const Map::Level> get_level(size_t index);
+    result_type calc_by_index(size_t index, double shift_x, double shift_y);
+
     result_type static calc_(const Map::Level& data, double shift_x, double shift_y);
+
     LazyMap m_summarize;
+    std::array<FieldIndex, FieldCount> m_field_indices;
+
+    std::mutex m_cache_mutex;
+    LruCache<size_t, std::shared_ptr<const Map::Level>> m_level_cache { LevelCacheSize };
+    LruCache<ResultKey, result_type, ResultKeyHash> m_result_cache { ResultCacheSize };
 };
 
 inline static auto& Tile = TilePack::get_instance();
@@ -1,9 +1,15 @@
 #include "OnnxSessions.h"
 
+#include <algorithm>
 #include <array>
+#include <cstdio>
 #include <filesystem>
 #include <string_view>
 
+#include <zlib.h>
+
+#include "Utils/CacheFile.hpp"
+#include "Utils/File.hpp"
 #include "Utils/Logger.hpp"
 
 #if __has_include(<onnxruntime/dml_provider_factory.h>)
@@ -35,12 +41,98 @@ Ort::Session& asst::OnnxSessions::get(const std::string& name)
 {
     if (m_sessions.find(name) == m_sessions.end()) {
         Log.info(__FUNCTION__, "lazy load", name);
-        Ort::Session session(m_env, m_model_paths.at(name).c_str(), m_options);
-        m_sessions.emplace(name, std::move(session));
+        m_sessions.emplace(name, create_session(m_model_paths.at(name)));
     }
     return m_sessions.at(name);
 }
 
+std::filesystem::path asst::OnnxSessions::optimized_model_cache_path(
+    const std::filesystem::path& model_path,
+    std::string_view model_data)
+{
+    using namespace asst::utils::path_literals;
+
+    uLong crc = crc32(0L, Z_NULL, 0);
+    // crc32 的长度参数是 uInt，大模型需要分块
+    constexpr size_t ChunkSize = 1ULL << 30;
+    for (size_t offset = 0; offset < model_data.size(); offset += ChunkSize) {
+        const size_t len = std::min(ChunkSize, model_data.size() - offset);
+        crc = crc32(crc, reinterpret_cast<const Bytef*>(model_data.data() + offset), static_cast<uInt>(len));
+    }
+
+    // 优化结果和 CPU 指令集有关，换了构建或者机器就重新优化
+    const auto& identity = utils::build_identity();
+    uLong build_crc = crc32(0L, Z_NULL, 0);
+    build_crc = crc32(build_crc, reinterpret_cast<const Bytef*>(identity.data()), static_cast<uInt>(identity.size()));
+
+    char key[48] = { 0 };
+    snprintf(
+        key,
+        sizeof(key),
+        "%08lx_%zx_b%08lx",
+        static_cast<unsigned long>(crc),
+        model_data.size(),
+        static_cast<unsigned long>(build_crc));
+
+    std::string filename = utils::path_to_utf8_string(model_path.stem()) + "_" + key + "_ort" +
+                           std::string(Ort::GetVersionString()) + ".onnx";
+    return UserDir.get() / "cache"_p / "onnx"_p / utils::path(filename);
+}
+
+Ort::Session asst::OnnxSessions::create_session(const std::filesystem::path& model_path)
+{
+    // GPU 的 EP 会把优化结果和设备绑定，只缓存 CPU 的
+    if (gpu_enabled) {
+        return Ort::Session(m_env, model_path.c_str(), m_options);
+    }
+
+    const auto model_data = utils::read_file<std::string>(model_path);
+    const auto cache_path = optimized_model_cache_path(model_path, model_data);
+
+    if (std::filesystem::exists(cache_path)) {
+        // 已经是优化过的图了，不需要再跑一遍优化
+        Ort::SessionOptions options = m_options.Clone();
+        options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_DISABLE_ALL);
+        try {
+            Ort::Session session(m_env, cache_path.c_str(), options);
+            Log.info(__FUNCTION__, "load optimized model from cache", cache_path.lexically_relative(UserDir.get()));
+            return session;
+        }
+        catch (const Ort::Exception& e) {
+            Log.warn(__FUNCTION__, "broken optimized model cache", e.what());
+            std::error_code ec;
+            std::filesystem::remove(cache_path, ec);
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(cache_path.parent_path(), ec);
+    utils::remove_stale_temp_files(cache_path.parent_path());
+    // 先写到临时文件，session 创建成功后再改名，避免中途退出留下半个文件
+    const auto temp_path = utils::unique_temp_path(cache_path);
+
+    Ort::SessionOptions options = m_options.Clone();
+    options.SetOptimizedModelFilePath(temp_path.c_str());
+    Ort::Session session { nullptr };
+    try {
+        session = Ort::Session(m_env, model_data.data(), model_data.size(), options);
+    }
+    catch (...) {
+        std::filesystem::remove(temp_path, ec);
+        throw;
+    }
+
+    std::filesystem::rename(temp_path, cache_path, ec);
+    if (ec) {
+        Log.warn(__FUNCTION__, "failed to save optimized model cache", ec.message());
+        std::filesystem::remove(temp_path, ec);
+    }
+    else {
+        Log.info(__FUNCTION__, "optimized model saved", cache_path.lexically_relative(UserDir.get()));
+    }
+    return session;
+}
+
 bool asst::OnnxSessions::use_cpu()
 {
     if (m_sessions.size() != 0) {
@@ -2,6 +2,7 @@
 
 #include "AbstractResource.h"
 
+#include <string_view>
 #include <unordered_map>
 
 #if __has_include(<onnxruntime_cxx_api.h>)
@@ -24,7 +25,14 @@ public:
     bool use_cpu();
     bool use_gpu(int device_id);
 
+    // ORT 优化后模型的缓存路径，以模型内容的 hash 和 ORT 版本作为 key
+    static std::filesystem::path optimized_model_cache_path(
+        const std::filesystem::path& model_path,
+        std::string_view model_data);
+
 private:
+    Ort::Session create_session(const std::filesystem::path& model_path);
+
     Ort::Env m_env;
     Ort::SessionOptions m_options;
     std::unordered_map<std::string, Ort::Session> m_sessions;
@@ -2,6 +2,7 @@
 
 #include <filesystem>
 #include <future>
+#include <unordered_map>
 
 #include "GeneralConfig.h"
 #include "Miscellaneous/AvatarCacheManager.h"
@@ -26,59 +27,6 @@
 #include "TemplResource.h"
 #include "Utils/Logger.hpp"
 
-asst::ResourceLoader::ResourceLoader()
-{
-    m_load_thread = std::thread(&ResourceLoader::load_thread_func, this);
-}
-
-void asst::ResourceLoader::load_thread_func()
-{
-    while (!m_load_thread_exit) {
-        std::unique_lock<std::mutex> lock(m_load_mutex);
-
-        if (m_load_queue.empty()) {
-            m_load_cv.wait(lock);
-            continue;
-        }
-
-        auto [res_ptr, path] = std::move(m_load_queue.front());
-        m_load_queue.pop_front();
-        lock.unlock();
-
-        res_ptr->load(path);
-    }
-}
-
-void asst::ResourceLoader::add_load_queue(AbstractResource& res, const std::filesystem::path& path)
-{
-    if (!std::filesystem::exists(path)) {
-        return;
-    }
-
-    std::unique_lock<std::mutex> lock(m_load_mutex);
-    m_load_queue.emplace_back(&res, path);
-    m_load_cv.notify_all();
-}
-
-void asst::ResourceLoader::cancel()
-{
-    m_load_thread_exit = true;
-
-    {
-        std::unique_lock<std::mutex> lock(m_load_mutex);
-        m_load_cv.notify_all();
-    }
-
-    if (m_load_thread.joinable()) {
-        m_load_thread.join();
-    }
-}
-
-asst::ResourceLoader::~ResourceLoader()
-{
-    cancel();
-}
-
 bool asst::ResourceLoader::load(const std::filesystem::path& path)
 {
     if (!std::filesystem::exists(path)) {
@@ -98,25 +46,14 @@ bool asst::ResourceLoader::load(const std::filesystem::path& path)
         }                                                         \
     }
 
-#ifdef ASST_DEBUG
-// DEBUG 模式下这里同步加载，并检查返回值的，方便排查问题
-#define AsyncLoadConfig(Config, Filename) LoadResourceAndCheckRet(Config, Filename)
-#else
-#define AsyncLoadConfig(Config, Filename)                                         \
-    {                                                                             \
-        add_load_queue(SingletonHolder<Config>::get_instance(), path / Filename); \
-    }
-#endif // ASST_DEBUG
-
-#define LoadResourceWithTemplAndCheckRet(Config, Filename, TemplDir)                             \
-    {                                                                                            \
-        auto full_path = path / Filename;                                                        \
-        auto full_templ_dir = path / TemplDir;                                                   \
-        bool ret = load_resource_with_templ<Config>(full_path, full_templ_dir);                  \
-        if (!ret) {                                                                              \
-            Log.error(#Config, "load failed, path:", full_path, ", templ dir:", full_templ_dir); \
-            return false;                                                                        \
-        }                                                                                        \
+#define LoadTemplByConfigAndCheckRet(Config, TemplDir)                           \
+    {                                                                            \
+        auto full_templ_dir = path / TemplDir;                                   \
+        bool ret = load_templ<Config>(full_templ_dir);                           \
+        if (!ret) {                                                              \
+            Log.error(#Config, "templ load failed, templ dir:", full_templ_dir); \
+            return false;                                                        \
+        }                                                                        \
     }
 
 #define LoadCacheWithoutRet(Config, Dir)                         \
@@ -131,89 +68,230 @@ bool asst::ResourceLoader::load(const std::filesystem::path& path)
     LogTraceFunction;
     using namespace asst::utils::path_literals;
 
-    // 太占内存的资源，都是惰性加载
-    // 战斗中技能识别，二分类模型
-    LoadResourceAndCheckRet(OnnxSessions, "onnx"_p / "skill_ready_cls.onnx"_p);
-    // 战斗中部署方向识别，四分类模型
-    LoadResourceAndCheckRet(OnnxSessions, "onnx"_p / "deploy_direction_cls.onnx"_p);
-    // 战斗中干员（血条）检测，yolov8 检测模型
-    LoadResourceAndCheckRet(OnnxSessions, "onnx"_p / "operators_det.onnx"_p);
+    // 不同的 job 并行加载，同一个 job 内按顺序加载；job 会等 depends 里的 job 全部成功后才开始
+    // 同一个资源类的多次 load 必须放在同一个 job 里，它们不是线程安全的
+    std::vector<LoadJob> jobs;
 
+    // 太占内存的资源，都是惰性加载
+    jobs.emplace_back(LoadJob {
+        .name = "OnnxSessions",
+        .func = [&]() {
+            // 战斗中技能识别，二分类模型
+            LoadResourceAndCheckRet(OnnxSessions, "onnx"_p / "skill_ready_cls.onnx"_p);
+            // 战斗中部署方向识别，四分类模型
+            LoadResourceAndCheckRet(OnnxSessions, "onnx"_p / "deploy_direction_cls.onnx"_p);
+            // 战斗中干员（血条）检测，yolov8 检测模型
+            LoadResourceAndCheckRet(OnnxSessions, "onnx"_p / "operators_det.onnx"_p);
+            return true;
+        },
+    });
     /* ocr */
-    LoadResourceAndCheckRet(WordOcr, "PaddleOCR"_p);
-    LoadResourceAndCheckRet(CharOcr, "PaddleCharOCR"_p);
+    jobs.emplace_back(LoadJob {
+        .name = "OcrPack",
+        .func = [&]() {
+            LoadResourceAndCheckRet(WordOcr, "PaddleOCR"_p);
+            LoadResourceAndCheckRet(CharOcr, "PaddleCharOCR"_p);
+            return true;
+        },
+    });
 
     // 重要的资源，实时加载
     /* load resource with json files*/
-    LoadResourceAndCheckRet(GeneralConfig, "config.json"_p);
-    LoadResourceAndCheckRet(RecruitConfig, "recruitment.json"_p);
-    LoadResourceAndCheckRet(BattleDataConfig, "battle_data.json"_p);
-    LoadResourceAndCheckRet(OcrConfig, "ocr_config.json"_p);
+    jobs.emplace_back(LoadJob {
+        .name = "GeneralConfig",
+        .func = [&]() {
+            LoadResourceAndCheckRet(GeneralConfig, "config.json"_p);
+            return true;
+        },
+    });
+    jobs.emplace_back(LoadJob {
+        .name = "RecruitConfig",
+        .func = [&]() {
+            LoadResourceAndCheckRet(RecruitConfig, "recruitment.json"_p);
+            return true;
+        },
+    });
+    jobs.emplace_back(LoadJob {
+        .name = "BattleDataConfig",
+        .func = [&]() {
+            LoadResourceAndCheckRet(BattleDataConfig, "battle_data.json"_p);
+            return true;
+        },
+    });
+    jobs.emplace_back(LoadJob {
+        .name = "OcrConfig",
+        .func = [&]() {
+            LoadResourceAndCheckRet(OcrConfig, "ocr_config.json"_p);
+            return true;
+        },
+    });
 
     /* load cache */
     // 这个任务依赖 BattleDataConfig
-    LoadCacheWithoutRet(AvatarCacheManager, "avatars"_p);
+    jobs.emplace_back(LoadJob {
+        .name = "AvatarCacheManager",
+        .depends = { "BattleDataConfig" },
+        .func = [&]() {
+            LoadCacheWithoutRet(AvatarCacheManager, "avatars"_p);
+            return true;
+        },
+    });
 
     // 重要的资源，实时加载（图片还是惰性的）
-    LoadResourceWithTemplAndCheckRet(TaskData, "tasks.json"_p, "template"_p);
+    // 生成任务时会按等价类编译 ocrReplace 的正则，依赖 OcrConfig
+    jobs.emplace_back(LoadJob {
+        .name = "TaskData",
+        .depends = { "OcrConfig" },
+        .func = [&]() {
+            LoadResourceAndCheckRet(TaskData, "tasks.json"_p);
+            return true;
+        },
+    });
     // 下面这几个资源都是会带OTA功能的，路径不能动
-    LoadResourceWithTemplAndCheckRet(InfrastConfig, "infrast.json"_p, "template"_p / "infrast"_p);
-    LoadResourceWithTemplAndCheckRet(ItemConfig, "item_index.json"_p, "template"_p / "items"_p);
-    LoadResourceAndCheckRet(StageDropsConfig, "stages.json"_p);
-    LoadResourceAndCheckRet(TilePack, "Arknights-Tile-Pos"_p / "overview.json"_p);
+    jobs.emplace_back(LoadJob {
+        .name = "InfrastConfig",
+        .func = [&]() {
+            LoadResourceAndCheckRet(InfrastConfig, "infrast.json"_p);
+            return true;
+        },
+    });
+    jobs.emplace_back(LoadJob {
+        .name = "ItemConfig",
+        .func = [&]() {
+            LoadResourceAndCheckRet(ItemConfig, "item_index.json"_p);
+            return true;
+        },
+    });
+    // 模板图片共用一个 TemplResource，按顺序处理
+    jobs.emplace_back(LoadJob {
+        .name = "TemplResource",
+        .depends = { "TaskData", "InfrastConfig", "ItemConfig" },
+        .func = [&]() {
+            LoadTemplByConfigAndCheckRet(TaskData, "template"_p);
+            LoadTemplByConfigAndCheckRet(InfrastConfig, "template"_p / "infrast"_p);
+            LoadTemplByConfigAndCheckRet(ItemConfig, "template"_p / "items"_p);
+            return true;
+        },
+    });
+    jobs.emplace_back(LoadJob {
+        .name = "StageDropsConfig",
+        .func = [&]() {
+            LoadResourceAndCheckRet(StageDropsConfig, "stages.json"_p);
+            return true;
+        },
+    });
+    jobs.emplace_back(LoadJob {
+        .name = "TilePack",
+        .func = [&]() {
+            LoadResourceAndCheckRet(TilePack, "Arknights-Tile-Pos"_p / "overview.json"_p);
+            return true;
+        },
+    });
 
     // fix #6188
     // https://github.com/MaaAssistantArknights/MaaAssistantArknights/issues/6188#issuecomment-1703705568
     // 没什么头绪，但凑合修掉了
-    // 原来这后面是用 AsyncLoadConfig 的，以下是原来的注释：
-    //// 不太重要又加载的慢的资源，但不怎么占内存的，实时异步加载
-    //// DEBUG 模式下这里还是检查返回值的，方便排查问题
+    // 原来这后面是用 AsyncLoadConfig 在 load 返回之后继续加载的，现在所有 job 都会在 load 返回前完成
     // –––––––– Roguelike Copilot Config ––––––––––––––––––––––––––––––––––––––––––––––
-    LoadResourceAndCheckRet(RoguelikeCopilotConfig, "roguelike"_p / "Phantom"_p / "autopilot"_p);
-    LoadResourceAndCheckRet(RoguelikeCopilotConfig, "roguelike"_p / "Mizuki"_p / "autopilot"_p);
-    LoadResourceAndCheckRet(RoguelikeCopilotConfig, "roguelike"_p / "Sami"_p / "autopilot"_p);
-    LoadResourceAndCheckRet(RoguelikeCopilotConfig, "roguelike"_p / "Sarkaz"_p / "autopilot"_p);
+    jobs.emplace_back(LoadJob {
+        .name = "RoguelikeCopilotConfig",
+        .func = [&]() {
+            LoadResourceAndCheckRet(RoguelikeCopilotConfig, "roguelike"_p / "Phantom"_p / "autopilot"_p);
+            LoadResourceAndCheckRet(RoguelikeCopilotConfig, "roguelike"_p / "Mizuki"_p / "autopilot"_p);
+            LoadResourceAndCheckRet(RoguelikeCopilotConfig, "roguelike"_p / "Sami"_p / "autopilot"_p);
+            LoadResourceAndCheckRet(RoguelikeCopilotConfig, "roguelike"_p / "Sarkaz"_p / "autopilot"_p);
+            return true;
+        },
+    });
 
     // –––––––– Roguelike Recruitment Config ––––––––––––––––––––––––––––––––––––––––––
-    LoadResourceAndCheckRet(RoguelikeRecruitConfig, "roguelike"_p / "Phantom"_p / "recruitment.json"_p);
-    LoadResourceAndCheckRet(RoguelikeRecruitConfig, "roguelike"_p / "Mizuki"_p / "recruitment.json"_p);
-    LoadResourceAndCheckRet(RoguelikeRecruitConfig, "roguelike"_p / "Sami"_p / "recruitment.json"_p);
-    LoadResourceAndCheckRet(RoguelikeRecruitConfig, "roguelike"_p / "Sarkaz"_p / "recruitment.json"_p);
+    // 需要从 BattleDataConfig 中查询干员职业
+    jobs.emplace_back(LoadJob {
+        .name = "RoguelikeRecruitConfig",
+        .depends = { "BattleDataConfig" },
+        .func = [&]() {
+            LoadResourceAndCheckRet(RoguelikeRecruitConfig, "roguelike"_p / "Phantom"_p / "recruitment.json"_p);
+            LoadResourceAndCheckRet(RoguelikeRecruitConfig, "roguelike"_p / "Mizuki"_p / "recruitment.json"_p);
+            LoadResourceAndCheckRet(RoguelikeRecruitConfig, "roguelike"_p / "Sami"_p / "recruitment.json"_p);
+            LoadResourceAndCheckRet(RoguelikeRecruitConfig, "roguelike"_p / "Sarkaz"_p / "recruitment.json"_p);
+            return true;
+        },
+    });
 
     // –––––––– Roguelike Shopping Config –––––––––––––––––––––––––––––––––––––––––––––
-    LoadResourceAndCheckRet(RoguelikeShoppingConfig, "roguelike"_p / "Phantom"_p / "shopping.json"_p);
-    LoadResourceAndCheckRet(RoguelikeShoppingConfig, "roguelike"_p / "Mizuki"_p / "shopping.json"_p);
-    LoadResourceAndCheckRet(RoguelikeShoppingConfig, "roguelike"_p / "Sami"_p / "shopping.json"_p);
-    LoadResourceAndCheckRet(RoguelikeShoppingConfig, "roguelike"_p / "Sarkaz"_p / "shopping.json"_p);
+    jobs.emplace_back(LoadJob {
+        .name = "RoguelikeShoppingConfig",
+        .func = [&]() {
+            LoadResourceAndCheckRet(RoguelikeShoppingConfig, "roguelike"_p / "Phantom"_p / "shopping.json"_p);
+            LoadResourceAndCheckRet(RoguelikeShoppingConfig, "roguelike"_p / "Mizuki"_p / "shopping.json"_p);
+            LoadResourceAndCheckRet(RoguelikeShoppingConfig, "roguelike"_p / "Sami"_p / "shopping.json"_p);
+            LoadResourceAndCheckRet(RoguelikeShoppingConfig, "roguelike"_p / "Sarkaz"_p / "shopping.json"_p);
+            return true;
+        },
+    });
 
     // –––––––– Roguelike Encounter Config ––––––––––––––––––––––––––––––––––––––––––––
-    LoadResourceAndCheckRet(
-        RoguelikeStageEncounterConfig,
-        "roguelike"_p / "Phantom"_p / "encounter"_p / "default.json"_p);
-    LoadResourceAndCheckRet(
-        RoguelikeStageEncounterConfig,
-        "roguelike"_p / "Mizuki"_p / "encounter"_p / "default.json"_p);
-    LoadResourceAndCheckRet(RoguelikeStageEncounterConfig, "roguelike"_p / "Sami"_p / "encounter"_p / "default.json"_p);
-    LoadResourceAndCheckRet(
-        RoguelikeStageEncounterConfig,
-        "roguelike"_p / "Sarkaz"_p / "encounter"_p / "default.json"_p);
-    LoadResourceAndCheckRet(
-        RoguelikeStageEncounterConfig,
-        "roguelike"_p / "Phantom"_p / "encounter"_p / "deposit.json"_p);
-    LoadResourceAndCheckRet(
-        RoguelikeStageEncounterConfig,
-        "roguelike"_p / "Mizuki"_p / "encounter"_p / "deposit.json"_p);
-    LoadResourceAndCheckRet(RoguelikeStageEncounterConfig, "roguelike"_p / "Sami"_p / "encounter"_p / "deposit.json"_p);
-    LoadResourceAndCheckRet(
-        RoguelikeStageEncounterConfig,
-        "roguelike"_p / "Sami"_p / "encounter"_p / "collapse.json"_p);
+    jobs.emplace_back(LoadJob {
+        .name = "RoguelikeStageEncounterConfig",
+        .func = [&]() {
+            LoadResourceAndCheckRet(
+                RoguelikeStageEncounterConfig,
+                "roguelike"_p / "Phantom"_p / "encounter"_p / "default.json"_p);
+            LoadResourceAndCheckRet(
+                RoguelikeStageEncounterConfig,
+                "roguelike"_p / "Mizuki"_p / "encounter"_p / "default.json"_p);
+            LoadResourceAndCheckRet(
+                RoguelikeStageEncounterConfig,
+                "roguelike"_p / "Sami"_p / "encounter"_p / "default.json"_p);
+            LoadResourceAndCheckRet(
+                RoguelikeStageEncounterConfig,
+                "roguelike"_p / "Sarkaz"_p / "encounter"_p / "default.json"_p);
+            LoadResourceAndCheckRet(
+                RoguelikeStageEncounterConfig,
+                "roguelike"_p / "Phantom"_p / "encounter"_p / "deposit.json"_p);
+            LoadResourceAndCheckRet(
+                RoguelikeStageEncounterConfig,
+                "roguelike"_p / "Mizuki"_p / "encounter"_p / "deposit.json"_p);
+            LoadResourceAndCheckRet(
+                RoguelikeStageEncounterConfig,
+                "roguelike"_p / "Sami"_p / "encounter"_p / "deposit.json"_p);
+            LoadResourceAndCheckRet(
+                RoguelikeStageEncounterConfig,
+                "roguelike"_p / "Sami"_p / "encounter"_p / "collapse.json"_p);
+            return true;
+        },
+    });
 
     // –––––––– Roguelike Map Config ––––––––––––––––––––––––––––––––––––––––––––------
-    LoadResourceAndCheckRet(RoguelikeMapConfig, "roguelike"_p / "Sarkaz"_p / "map.json"_p);
+    jobs.emplace_back(LoadJob {
+        .name = "RoguelikeMapConfig",
+        .func = [&]() {
+            LoadResourceAndCheckRet(RoguelikeMapConfig, "roguelike"_p / "Sarkaz"_p / "map.json"_p);
+            return true;
+        },
+    });
 
     // –––––––– Sami Plugin Config ––––––––––––––––––––––––––––––––––––––––––––––––––––
-    LoadResourceAndCheckRet(RoguelikeFoldartalConfig, "roguelike"_p / "Sami"_p / "foldartal.json"_p);
-    LoadResourceAndCheckRet(RoguelikeCollapsalParadigmConfig, "roguelike"_p / "Sami"_p / "collapsal_paradigms.json"_p);
+    jobs.emplace_back(LoadJob {
+        .name = "RoguelikeFoldartalConfig",
+        .func = [&]() {
+            LoadResourceAndCheckRet(RoguelikeFoldartalConfig, "roguelike"_p / "Sami"_p / "foldartal.json"_p);
+            return true;
+        },
+    });
+    jobs.emplace_back(LoadJob {
+        .name = "RoguelikeCollapsalParadigmConfig",
+        .func = [&]() {
+            LoadResourceAndCheckRet(
+                RoguelikeCollapsalParadigmConfig,
+                "roguelike"_p / "Sami"_p / "collapsal_paradigms.json"_p);
+            return true;
+        },
+    });
+
+    if (!run_load_jobs(jobs)) {
+        return false;
+    }
 
 #undef LoadTemplByConfigAndCheckRet
 #undef LoadResourceAndCheckRet
@@ -225,6 +303,53 @@ bool asst::ResourceLoader::load(const std::filesystem::path& path)
     return m_loaded;
 }
 
+bool asst::ResourceLoader::run_load_jobs(const std::vector<LoadJob>& jobs)
+{
+    LogTraceFunction;
+
+    std::unordered_map<std::string_view, std::shared_future<bool>> futures;
+    std::vector<std::shared_future<bool>> ordered;
+    ordered.reserve(jobs.size());
+
+    for (const auto& job : jobs) {
+        // depends 只能引用前面声明过的 job，所以不会成环
+        std::vector<std::shared_future<bool>> depends;
+        bool depends_valid = true;
+        for (const auto& dep : job.depends) {
+            auto iter = futures.find(dep);
+            if (iter == futures.end()) {
+                Log.error(__FUNCTION__, "unknown depend", dep, "of", job.name);
+                depends_valid = false;
+                continue;
+            }
+            depends.emplace_back(iter->second);
+        }
+
+        auto future = std::async(std::launch::async, [&job, depends = std::move(depends), depends_valid]() {
+                          bool ret = depends_valid;
+                          // 即使前置失败了也要等它们结束，避免 load 返回后还有 job 在跑
+                          for (const auto& dep : depends) {
+                              ret = dep.get() && ret;
+                          }
+                          if (!ret) {
+                              return false;
+                          }
+                          return job.func();
+                      }).share();
+        futures.emplace(job.name, future);
+        ordered.emplace_back(std::move(future));
+    }
+
+    bool ret = true;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        if (!ordered[i].get()) {
+            Log.error(__FUNCTION__, "job failed", jobs[i].name);
+            ret = false;
+        }
+    }
+    return ret;
+}
+
 void asst::ResourceLoader::set_connection_extras(const std::string& name, const json::object& diff)
 {
     GeneralConfig::get_instance().set_connection_extras(name, diff);
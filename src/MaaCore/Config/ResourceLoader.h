@@ -2,9 +2,12 @@
 
 #include "AbstractResource.h"
 
-#include <deque>
 #include <filesystem>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
 #include "AbstractConfigWithTempl.h"
 #include "TemplResource.h"
@@ -15,7 +18,7 @@ namespace asst
 class ResourceLoader final : public SingletonHolder<ResourceLoader>, public AbstractResource
 {
 public:
-    virtual ~ResourceLoader() override;
+    virtual ~ResourceLoader() override = default;
 
     virtual bool load(const std::filesystem::path& path) override;
 
@@ -23,13 +26,9 @@ public:
     bool loaded() const noexcept;
 
 public:
-    ResourceLoader();
-
-    void cancel();
+    ResourceLoader() = default;
 
 private:
-    void load_thread_func();
-
     template <Singleton T>
     requires std::is_base_of_v<AbstractResource, T>
     bool load_resource(const std::filesystem::path& path)
@@ -40,13 +39,11 @@ private:
         return SingletonHolder<T>::get_instance().load(path);
     }
 
+    // 需要 T 已经加载完成
     template <Singleton T>
     requires std::is_base_of_v<AbstractConfigWithTempl, T>
-    bool load_resource_with_templ(const std::filesystem::path& path, const std::filesystem::path& templ_dir)
+    bool load_templ(const std::filesystem::path& templ_dir)
     {
-        if (!load_resource<T>(path)) {
-            return false;
-        }
         static auto& templ_ins = SingletonHolder<TemplResource>::get_instance();
         const auto& required = SingletonHolder<T>::get_instance().get_templ_required();
         templ_ins.set_load_required(required);
@@ -54,17 +51,18 @@ private:
         return load_resource<TemplResource>(templ_dir);
     }
 
-    void add_load_queue(AbstractResource& res, const std::filesystem::path& path);
+    struct LoadJob
+    {
+        std::string name;
+        std::vector<std::string> depends {}; // 依赖的 job 的 name，必须在前面声明
+        std::function<bool()> func;
+    };
+
+    // 所有 job 并行执行，等全部结束后返回，任何一个失败都返回 false
+    bool run_load_jobs(const std::vector<LoadJob>& jobs);
 
 private:
     bool m_loaded = false;
     std::mutex m_entry_mutex;
-
-    // only for async load
-    bool m_load_thread_exit = false;
-    std::deque<std::pair<AbstractResource*, std::filesystem::path>> m_load_queue;
-    std::mutex m_load_mutex;
-    std::condition_variable m_load_cv;
-    std::thread m_load_thread;
 };
 } // namespace asst
@@ -1,15 +1,20 @@
 #include "TaskData.h"
 
 #include <algorithm>
+#include <cstdio>
 #include <meojson/json.hpp>
 #include <regex>
 
+#include <zlib.h>
+
 #ifdef ASST_DEBUG
 #include <queue>
 #endif
 
 #include "Common/AsstTypes.h"
 #include "GeneralConfig.h"
+#include "Miscellaneous/OcrConfig.h"
+#include "TaskData/TaskDataCache.h"
 #include "TaskData/TaskDataSymbolStream.h"
 #include "TaskData/TaskDataTypes.h"
 #include "TemplResource.h"
@@ -66,6 +71,44 @@ asst::TaskPtr asst::TaskData::get(std::string_view name)
     }
 }
 
+asst::TaskNameId asst::TaskData::name_id(std::string_view name)
+{
+    {
+        std::shared_lock lock(m_name_ids_mutex);
+        if (auto it = m_name_ids.find(name); it != m_name_ids.cend()) {
+            return it->second;
+        }
+    }
+
+    std::unique_lock lock(m_name_ids_mutex);
+    return name_id_unlocked(name);
+}
+
+asst::TaskNameId asst::TaskData::name_id_unlocked(std::string_view name)
+{
+    // 可能在拿到写锁之前已经被别的线程分配了
+    if (auto it = m_name_ids.find(name); it != m_name_ids.cend()) {
+        return it->second;
+    }
+
+    std::string_view name_view = m_id_names.emplace_back(name);
+    const auto id = static_cast<TaskNameId>(m_suffix_name_ids.size());
+    m_suffix_name_ids.emplace_back(InvalidTaskNameId);
+    m_name_ids.emplace(name_view, id);
+
+    if (size_t pos = name_view.find('@'); pos != std::string_view::npos) {
+        const TaskNameId suffix_id = name_id_unlocked(name_view.substr(pos + 1));
+        m_suffix_name_ids[id] = suffix_id;
+    }
+    return id;
+}
+
+asst::TaskNameId asst::TaskData::suffix_name_id(TaskNameId id) noexcept
+{
+    std::shared_lock lock(m_name_ids_mutex);
+    return id < m_suffix_name_ids.size() ? m_suffix_name_ids[id] : InvalidTaskNameId;
+}
+
 bool asst::TaskData::lazy_parse(const json::value& json)
 {
     LogTraceFunction;
@@ -189,12 +232,9 @@ bool asst::TaskData::lazy_parse(const json::value& json)
             // 用于解决 a8d68dd72df6eef1d2f8feed3883299922ec1a17 类似的潜在regex非法问题
             if (auto ocr_task = std::dynamic_pointer_cast<OcrTaskInfo>(task);
                 task->algorithm == AlgorithmType::OcrDetect) {
-                for (const auto& [regex, new_str] : ocr_task->replace_map) {
-                    try {
-                        std::regex _(regex);
-                    }
-                    catch (const std::regex_error& e) {
-                        Log.error("Task", name, "has invalid regex:", regex, ":", e.what());
+                for (const auto& regex : ocr_task->replace_map | views::keys) {
+                    if (!OcrConfig::get_instance().get_replace_regex(regex)) {
+                        Log.error("Task", name, "has invalid regex:", regex);
                         validity = false;
                         break;
                     }
@@ -226,11 +266,82 @@ bool asst::TaskData::parse(const json::value& json)
         return false;
     }
 
+#ifndef ASST_DEBUG
+    // DEBUG 模式下每次都完整生成一遍，保留生成时的各种检查和警告
+    const std::string cache_key = task_cache_key();
+    if (load_task_cache(cache_key)) {
+        return true;
+    }
+#endif
+
     // 本来重构之后完全支持惰性加载，但是发现模板图片不支持（
+    // 顺便把生成的结果存下来，避免任务链跑到一半时才去生成
     for (std::string_view name : m_json_all_tasks_info | views::keys) {
-        generate_task_info(name);
+        get(name);
+    }
+
+#ifndef ASST_DEBUG
+    TaskDataCache::save(TaskDataCache::cache_path(cache_key), cache_key, m_all_tasks_info, m_templ_required);
+#endif
+
+    return true;
+}
+
+std::string asst::TaskData::task_cache_key() const
+{
+    // json::object 内部是有序的，只需要把任务名排个序
+    std::vector<std::string_view> names;
+    names.reserve(m_json_all_tasks_info.size());
+    ranges::copy(m_json_all_tasks_info | views::keys, std::back_inserter(names));
+    ranges::sort(names);
+
+    uLong crc = crc32(0L, Z_NULL, 0);
+    size_t total_size = 0;
+    for (std::string_view name : names) {
+        std::string content = std::string(name) + '\0' + m_json_all_tasks_info.at(name).to_string() + '\n';
+        crc = crc32(crc, reinterpret_cast<const Bytef*>(content.data()), static_cast<uInt>(content.size()));
+        total_size += content.size();
+    }
+
+    char key[48] = { 0 };
+    snprintf(
+        key,
+        sizeof(key),
+        "g%u_%08lx_%zx",
+        static_cast<unsigned>(TaskGeneratorVersion),
+        static_cast<unsigned long>(crc),
+        total_size);
+    return key;
+}
+
+bool asst::TaskData::load_task_cache(const std::string& key)
+{
+    LogTraceFunction;
+
+    auto content_opt = TaskDataCache::load(TaskDataCache::cache_path(key), key);
+    if (!content_opt) {
+        return false;
+    }
+
+    for (TaskPtr& task : content_opt->tasks) {
+        // 编号只在进程内有效，不存到缓存里
+        task->name_id = name_id(task->name);
+        std::string name = task->name;
+        insert_or_assign_task(name, std::move(task));
     }
+    m_templ_required.merge(content_opt->templ_required);
 
+    // 生成任务时就把正则编译好，OCRer 里直接复用
+    auto& ocr_config = OcrConfig::get_instance();
+    for (const auto& task : m_all_tasks_info | views::values) {
+        if (auto ocr_task = std::dynamic_pointer_cast<OcrTaskInfo>(task)) {
+            for (const auto& regex : ocr_task->replace_map | views::keys) {
+                std::ignore = ocr_config.get_replace_regex(regex);
+            }
+        }
+    }
+
+    Log.info("load", m_all_tasks_info.size(), "tasks from cache");
     return true;
 }
 
@@ -476,6 +587,7 @@ asst::TaskPtr asst::TaskData::generate_task_info(std::string_view name)
 #endif
     task->algorithm = algorithm;
     task->name = name;
+    task->name_id = name_id(name);
 
     return task;
 }
@@ -717,6 +829,11 @@ asst::TaskPtr asst::TaskData::generate_ocr_task_info(
         "ocrReplace",
         ocr_task_info_ptr->replace_map,
         default_ptr->replace_map);
+    // 生成任务时就把正则编译好，OCRer 里直接复用
+    auto& ocr_config = OcrConfig::get_instance();
+    for (const auto& regex : ocr_task_info_ptr->replace_map | views::keys) {
+        std::ignore = ocr_config.get_replace_regex(regex);
+    }
     return ocr_task_info_ptr;
 }
 
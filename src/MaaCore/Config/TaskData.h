@@ -2,6 +2,8 @@
 
 #include "AbstractConfigWithTempl.h"
 
+#include <deque>
+#include <shared_mutex>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -43,6 +45,14 @@ private:
 
     static const std::string& task_name_view(std::string_view name) { return *m_task_names.emplace(name).first; }
 
+    // 资源加载完之后各个实例的任务线程还会分配编号（set_times_limit、隐式的 `@` 任务等），读写都要加锁
+    static inline std::shared_mutex m_name_ids_mutex;
+    static inline std::deque<std::string> m_id_names {}; // 下标为 TaskNameId，deque 扩容不会让 m_name_ids 的 key 失效
+    static inline std::unordered_map<std::string_view, TaskNameId> m_name_ids {};
+    static inline std::vector<TaskNameId> m_suffix_name_ids {}; // 下标为 TaskNameId
+
+    static TaskNameId name_id_unlocked(std::string_view name);
+
     struct RawCompileResult
     {
         bool task_changed;
@@ -94,6 +104,13 @@ private:
 #endif
     TaskDerivedConstPtr get_raw(std::string_view name);
 
+    // generate_task_info 等展开任务的逻辑有任何变化都要加一，不然会读到按旧逻辑展开的缓存
+    static constexpr uint32_t TaskGeneratorVersion = 1;
+
+    // 由合并后的任务 json 和 TaskGeneratorVersion 计算，用来区分不同的二进制缓存
+    std::string task_cache_key() const;
+    bool load_task_cache(const std::string& key);
+
 public:
     virtual ~TaskData() override = default;
     virtual const std::unordered_set<std::string>& get_templ_required() const noexcept override;
@@ -103,6 +120,11 @@ public:
 
     TaskPtr get(std::string_view name);
 
+    // 任务名第一次出现时分配编号，之后不会变，用来代替字符串做 key
+    static TaskNameId name_id(std::string_view name);
+    // 去掉第一个 `@` 及之前的部分后的任务名编号，例如 "C@B@A" -> "B@A"；没有 `@` 时返回 InvalidTaskNameId
+    static TaskNameId suffix_name_id(TaskNameId id) noexcept;
+
     template <typename TargetTaskInfoType>
     requires(
         std::derived_from<TargetTaskInfoType, TaskInfo> &&
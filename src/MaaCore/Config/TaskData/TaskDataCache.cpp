@@ -0,0 +1,272 @@
+#include "TaskDataCache.h"
+
+#include <algorithm>
+#include <fstream>
+
+#include "Utils/BinaryStream.hpp"
+#include "Utils/CacheFile.hpp"
+#include "Utils/File.hpp"
+#include "Utils/Logger.hpp"
+#include "Utils/Platform.hpp"
+#include "Utils/Ranges.hpp"
+
+namespace
+{
+using asst::utils::BinaryReader;
+using asst::utils::BinaryWriter;
+
+constexpr std::string_view Magic = "MAATASK";
+
+enum class InfoType : uint8_t
+{
+    Basic,
+    Match,
+    Ocr,
+};
+
+void write_task(BinaryWriter& writer, const asst::TaskInfo& task)
+{
+    using namespace asst;
+
+    const auto* match = dynamic_cast<const MatchTaskInfo*>(&task);
+    const auto* ocr = dynamic_cast<const OcrTaskInfo*>(&task);
+    writer.write(match ? InfoType::Match : (ocr ? InfoType::Ocr : InfoType::Basic));
+
+    writer.write(task.name);
+    writer.write(task.next);
+    writer.write(task.sub);
+    writer.write(task.on_error_next);
+    writer.write(task.exceeded_next);
+    writer.write(task.reduce_other_times);
+    writer.write(task.algorithm);
+    writer.write(task.action);
+    writer.write(task.sub_error_ignored);
+    writer.write(task.max_times);
+    writer.write(task.specific_rect);
+    writer.write(task.pre_delay);
+    writer.write(task.post_delay);
+    writer.write(task.retry_times);
+    writer.write(task.roi);
+    writer.write(task.rect_move);
+    writer.write(task.cache);
+    writer.write(task.special_params);
+    writer.write(task.input_text);
+
+    if (match) {
+        writer.write(match->templ_names);
+        writer.write(match->templ_thresholds);
+        writer.write(match->methods);
+        writer.write(match->mask_ranges);
+        writer.write(match->color_scales);
+        writer.write(match->color_close);
+    }
+    else if (ocr) {
+        writer.write(ocr->text);
+        writer.write(ocr->full_match);
+        writer.write(ocr->is_ascii);
+        writer.write(ocr->without_det);
+        writer.write(ocr->replace_full);
+        writer.write(ocr->replace_map);
+    }
+}
+
+asst::TaskPtr read_task(BinaryReader& reader)
+{
+    using namespace asst;
+
+    InfoType type = InfoType::Basic;
+    reader.read(type);
+
+    TaskPtr task = nullptr;
+    MatchTaskPtr match = nullptr;
+    OcrTaskPtr ocr = nullptr;
+    switch (type) {
+    case InfoType::Basic:
+        task = std::make_shared<TaskInfo>();
+        break;
+    case InfoType::Match:
+        task = match = std::make_shared<MatchTaskInfo>();
+        break;
+    case InfoType::Ocr:
+        task = ocr = std::make_shared<OcrTaskInfo>();
+        break;
+    default:
+        return nullptr;
+    }
+
+    reader.read(task->name);
+    reader.read(task->next);
+    reader.read(task->sub);
+    reader.read(task->on_error_next);
+    reader.read(task->exceeded_next);
+    reader.read(task->reduce_other_times);
+    reader.read(task->algorithm);
+    reader.read(task->action);
+    reader.read(task->sub_error_ignored);
+    reader.read(task->max_times);
+    reader.read(task->specific_rect);
+    reader.read(task->pre_delay);
+    reader.read(task->post_delay);
+    reader.read(task->retry_times);
+    reader.read(task->roi);
+    reader.read(task->rect_move);
+    reader.read(task->cache);
+    reader.read(task->special_params);
+    reader.read(task->input_text);
+
+    if (match) {
+        reader.read(match->templ_names);
+        reader.read(match->templ_thresholds);
+        reader.read(match->methods);
+        reader.read(match->mask_ranges);
+        reader.read(match->color_scales);
+        reader.read(match->color_close);
+    }
+    else if (ocr) {
+        reader.read(ocr->text);
+        reader.read(ocr->full_match);
+        reader.read(ocr->is_ascii);
+        reader.read(ocr->without_det);
+        reader.read(ocr->replace_full);
+        reader.read(ocr->replace_map);
+    }
+
+    return reader.ok() ? task : nullptr;
+}
+}
+
+std::filesystem::path asst::TaskDataCache::cache_path(std::string_view key)
+{
+    using namespace asst::utils::path_literals;
+    return UserDir.get() / "cache"_p / "tasks"_p / utils::path(std::string(key) + ".bin");
+}
+
+std::optional<asst::TaskDataCache::Content>
+    asst::TaskDataCache::load(const std::filesystem::path& path, std::string_view key)
+{
+    if (!std::filesystem::exists(path)) {
+        return std::nullopt;
+    }
+
+    const auto data = utils::read_file<std::string>(path);
+    BinaryReader reader(data);
+
+    std::string magic;
+    uint32_t format_version = 0;
+    std::string build;
+    std::string file_key;
+    reader.read(magic);
+    reader.read(format_version);
+    reader.read(build);
+    reader.read(file_key);
+    // 别的构建写的缓存不用，任务的展开方式可能已经不同了
+    if (!reader.ok() || magic != Magic || format_version != FormatVersion || build != utils::build_identity() ||
+        file_key != key) {
+        Log.info(__FUNCTION__, "outdated task cache", path.lexically_relative(UserDir.get()));
+        return std::nullopt;
+    }
+
+    Content content;
+    uint32_t task_count = 0;
+    reader.read(task_count);
+    content.tasks.reserve(std::min<size_t>(task_count, data.size()));
+    for (uint32_t i = 0; i < task_count && reader.ok(); ++i) {
+        auto task = read_task(reader);
+        if (!task) {
+            break;
+        }
+        content.tasks.emplace_back(std::move(task));
+    }
+
+    std::vector<std::string> templ_required;
+    reader.read(templ_required);
+    content.templ_required.insert(
+        std::make_move_iterator(templ_required.begin()),
+        std::make_move_iterator(templ_required.end()));
+
+    if (!reader.ok() || !reader.eof() || content.tasks.size() != task_count) {
+        Log.warn(__FUNCTION__, "broken task cache", path.lexically_relative(UserDir.get()));
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        return std::nullopt;
+    }
+
+    // 用修改时间记录最近一次使用，清理的时候留下最近用过的
+    std::error_code ec;
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+
+    return content;
+}
+
+bool asst::TaskDataCache::save(
+    const std::filesystem::path& path,
+    std::string_view key,
+    const std::unordered_map<std::string_view, TaskPtr>& tasks,
+    const std::unordered_set<std::string>& templ_required)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    // 先写到临时文件再改名，避免中途退出留下半个文件；临时文件名带随机后缀，多个进程同时写也不会互相覆盖
+    const auto temp_path = utils::unique_temp_path(path);
+    try {
+        BinaryWriter writer;
+        writer.write(Magic);
+        writer.write(FormatVersion);
+        writer.write(utils::build_identity());
+        writer.write(key);
+
+        writer.write(static_cast<uint32_t>(tasks.size()));
+        for (const auto& task : tasks | views::values) {
+            write_task(writer, *task);
+        }
+        writer.write(std::vector<std::string>(templ_required.begin(), templ_required.end()));
+
+        std::ofstream ofs(temp_path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!ofs.is_open()) {
+            Log.warn(__FUNCTION__, "failed to open", temp_path.lexically_relative(UserDir.get()));
+            return false;
+        }
+        ofs.write(writer.buffer().data(), static_cast<std::streamsize>(writer.buffer().size()));
+        ofs.close();
+        if (!ofs.good()) {
+            std::filesystem::remove(temp_path, ec);
+            return false;
+        }
+    }
+    catch (const std::exception& e) {
+        Log.warn(__FUNCTION__, "failed to write task cache", e.what());
+        std::filesystem::remove(temp_path, ec);
+        return false;
+    }
+
+    std::filesystem::rename(temp_path, path, ec);
+    if (ec) {
+        Log.warn(__FUNCTION__, "failed to save task cache", ec.message());
+        std::filesystem::remove(temp_path, ec);
+        return false;
+    }
+    Log.info(__FUNCTION__, "task cache saved", path.lexically_relative(UserDir.get()), tasks.size());
+
+    prune(path.parent_path());
+    return true;
+}
+
+void asst::TaskDataCache::prune(const std::filesystem::path& dir)
+{
+    utils::remove_stale_temp_files(dir);
+
+    std::error_code ec;
+    std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> files;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+        if (entry.is_regular_file(ec) && entry.path().extension() == ".bin") {
+            files.emplace_back(entry.last_write_time(ec), entry.path());
+        }
+    }
+    if (files.size() <= MaxCacheFiles) {
+        return;
+    }
+    ranges::sort(files, std::greater {}, [](const auto& file) { return file.first; });
+    for (const auto& file : files | views::drop(MaxCacheFiles)) {
+        std::filesystem::remove(file.second, ec);
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Common/AsstTypes.h"
+
+namespace asst
+{
+// 已展开的任务的二进制缓存，key 由合并后的任务 json 和展开逻辑的版本计算得到，任一变化都会换一个文件
+// FormatVersion 只管文件本身的格式，展开逻辑的版本见 TaskData::TaskGeneratorVersion
+class TaskDataCache final
+{
+public:
+    struct Content
+    {
+        std::vector<TaskPtr> tasks;
+        std::unordered_set<std::string> templ_required;
+    };
+
+    // 按 key 计算缓存文件路径
+    static std::filesystem::path cache_path(std::string_view key);
+
+    static std::optional<Content> load(const std::filesystem::path& path, std::string_view key);
+    static bool save(
+        const std::filesystem::path& path,
+        std::string_view key,
+        const std::unordered_map<std::string_view, TaskPtr>& tasks,
+        const std::unordered_set<std::string>& templ_required);
+
+private:
+    // 删掉最久没用过的缓存，只保留最近的几份（官服 + 外服叠加后的结果各一份）
+    static void prune(const std::filesystem::path& dir);
+
+    static constexpr uint32_t FormatVersion = 1;
+    static constexpr size_t MaxCacheFiles = 4;
+};
+} // namespace asst
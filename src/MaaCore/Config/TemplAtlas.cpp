@@ -0,0 +1,202 @@
+#include "TemplAtlas.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <thread>
+
+#include <zlib.h>
+
+#include "Utils/BinaryStream.hpp"
+#include "Utils/ImageIo.hpp"
+#include "Utils/Logger.hpp"
+#include "Utils/Ranges.hpp"
+
+namespace
+{
+constexpr std::string_view Magic = "MAATMPL";
+}
+
+std::filesystem::path asst::TemplAtlas::atlas_path(const TemplFiles& files)
+{
+    using namespace asst::utils::path_literals;
+
+    std::vector<const TemplFiles::value_type*> sorted;
+    sorted.reserve(files.size());
+    ranges::transform(files, std::back_inserter(sorted), [](const auto& file) { return &file; });
+    ranges::sort(sorted, std::less {}, [](const auto* file) { return file->first; });
+
+    uLong crc = crc32(0L, Z_NULL, 0);
+    for (const auto* file : sorted) {
+        std::error_code ec;
+        const auto size = std::filesystem::file_size(file->second, ec);
+        const auto mtime = std::filesystem::last_write_time(file->second, ec).time_since_epoch().count();
+        std::string content = file->first + '\0' + utils::path_to_utf8_string(file->second) + '\0' +
+                              std::to_string(size) + '\0' + std::to_string(mtime) + '\n';
+        crc = crc32(crc, reinterpret_cast<const Bytef*>(content.data()), static_cast<uInt>(content.size()));
+    }
+
+    char key[32] = { 0 };
+    snprintf(key, sizeof(key), "%08lx_%zx.atlas", static_cast<unsigned long>(crc), files.size());
+    return UserDir.get() / "cache"_p / "templates"_p / utils::path(key);
+}
+
+bool asst::TemplAtlas::build(const std::filesystem::path& path, const TemplFiles& files)
+{
+    LogTraceFunction;
+
+    // 解码是大头，分几个线程并行做
+    std::vector<cv::Mat> images(files.size());
+    const size_t thread_count = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, 8);
+    std::vector<std::future<void>> futures;
+    for (size_t t = 0; t < thread_count; ++t) {
+        futures.emplace_back(std::async(std::launch::async, [&, t]() {
+            for (size_t i = t; i < files.size(); i += thread_count) {
+                images[i] = asst::imread(files[i].second);
+            }
+        }));
+    }
+    for (auto& future : futures) {
+        future.get();
+    }
+
+    utils::BinaryWriter writer;
+    writer.write(Magic);
+    writer.write(FormatVersion);
+    const size_t index_offset_pos = writer.size();
+    writer.write(uint64_t { 0 });
+
+    std::vector<uint64_t> offsets(files.size(), 0);
+    for (size_t i = 0; i < files.size(); ++i) {
+        cv::Mat& image = images[i];
+        if (image.empty()) {
+            Log.error(__FUNCTION__, "failed to decode", files[i].second);
+            return false;
+        }
+        if (!image.isContinuous()) {
+            image = image.clone();
+        }
+        writer.align(DataAlignment);
+        offsets[i] = writer.size();
+        writer.write_bytes(image.data, image.total() * image.elemSize());
+    }
+
+    writer.align(DataAlignment);
+    writer.overwrite(index_offset_pos, static_cast<uint64_t>(writer.size()));
+    writer.write(static_cast<uint32_t>(files.size()));
+    for (size_t i = 0; i < files.size(); ++i) {
+        writer.write(files[i].first);
+        writer.write(static_cast<int32_t>(images[i].rows));
+        writer.write(static_cast<int32_t>(images[i].cols));
+        writer.write(static_cast<int32_t>(images[i].type()));
+        writer.write(offsets[i]);
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    // 先写到临时文件再改名，其他进程只会看到完整的图集
+    auto temp_path = path;
+    temp_path += ".tmp";
+    {
+        std::ofstream ofs(temp_path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!ofs.is_open()) {
+            Log.warn(__FUNCTION__, "failed to open", temp_path.lexically_relative(UserDir.get()));
+            return false;
+        }
+        ofs.write(writer.buffer().data(), static_cast<std::streamsize>(writer.buffer().size()));
+        if (!ofs.good()) {
+            ofs.close();
+            std::filesystem::remove(temp_path, ec);
+            return false;
+        }
+    }
+    std::filesystem::rename(temp_path, path, ec);
+    if (ec) {
+        Log.warn(__FUNCTION__, "failed to save atlas", ec.message());
+        std::filesystem::remove(temp_path, ec);
+        return false;
+    }
+    Log.info(__FUNCTION__, "atlas saved", path.lexically_relative(UserDir.get()), files.size(), writer.size());
+
+    prune(path.parent_path());
+    return true;
+}
+
+std::shared_ptr<asst::TemplAtlas> asst::TemplAtlas::open(const std::filesystem::path& path)
+{
+    utils::file_mapping mapping(path);
+    if (!mapping) {
+        return nullptr;
+    }
+
+    const std::string_view data(reinterpret_cast<const char*>(mapping.data()), mapping.size());
+    utils::BinaryReader reader(data);
+
+    std::string magic;
+    uint32_t format_version = 0;
+    uint64_t index_offset = 0;
+    reader.read(magic);
+    reader.read(format_version);
+    reader.read(index_offset);
+    if (!reader.ok() || magic != Magic || format_version != FormatVersion) {
+        Log.info(__FUNCTION__, "outdated atlas", path.lexically_relative(UserDir.get()));
+        return nullptr;
+    }
+
+    auto atlas = std::make_shared<TemplAtlas>();
+    reader.seek(static_cast<size_t>(index_offset));
+    uint32_t count = 0;
+    reader.read(count);
+    for (uint32_t i = 0; i < count && reader.ok(); ++i) {
+        std::string name;
+        int32_t rows = 0;
+        int32_t cols = 0;
+        int32_t type = 0;
+        uint64_t offset = 0;
+        reader.read(name);
+        reader.read(rows);
+        reader.read(cols);
+        reader.read(type);
+        reader.read(offset);
+
+        const size_t bytes = static_cast<size_t>(rows) * static_cast<size_t>(cols) * CV_ELEM_SIZE(type);
+        if (!reader.ok() || rows <= 0 || cols <= 0 || offset > data.size() || bytes > data.size() - offset) {
+            Log.warn(__FUNCTION__, "broken atlas", path.lexically_relative(UserDir.get()));
+            return nullptr;
+        }
+        // cv::Mat 只接受非 const 指针，映射本身是只读的，调用方不能写入
+        auto* ptr = const_cast<std::byte*>(mapping.data() + offset);
+        atlas->m_templs.emplace(std::move(name), cv::Mat(rows, cols, type, ptr));
+    }
+    if (!reader.ok() || atlas->m_templs.size() != count) {
+        Log.warn(__FUNCTION__, "broken atlas", path.lexically_relative(UserDir.get()));
+        return nullptr;
+    }
+    atlas->m_mapping = std::move(mapping);
+
+    // 用修改时间记录最近一次使用，清理的时候留下最近用过的
+    std::error_code ec;
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+
+    return atlas;
+}
+
+void asst::TemplAtlas::prune(const std::filesystem::path& dir)
+{
+    std::error_code ec;
+    std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> files;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+        if (entry.is_regular_file(ec) && entry.path().extension() == ".atlas") {
+            files.emplace_back(entry.last_write_time(ec), entry.path());
+        }
+    }
+    if (files.size() <= MaxAtlasFiles) {
+        return;
+    }
+    ranges::sort(files, std::greater {}, [](const auto& file) { return file.first; });
+    // 正在被映射的图集在 Windows 上删不掉，下次再清理
+    for (const auto& file : files | views::drop(MaxAtlasFiles)) {
+        std::filesystem::remove(file.second, ec);
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Utils/NoWarningCVMat.h"
+#include "Utils/Platform.hpp"
+
+namespace asst
+{
+// 预先解码好的模板图集。整个文件只读映射到内存中，模板的 cv::Mat 直接指向映射的内存，
+// 多个实例、多个进程打开同一个图集时共享物理页，也省掉了运行中途第一次用到模板时的解码
+class TemplAtlas
+{
+public:
+    using TemplFiles = std::vector<std::pair<std::string, std::filesystem::path>>; // name, path
+
+    // 按模板文件的路径、大小和修改时间计算图集路径，任何一个文件变了都会换一个图集
+    static std::filesystem::path atlas_path(const TemplFiles& files);
+
+    // 解码所有模板并写入图集文件
+    static bool build(const std::filesystem::path& path, const TemplFiles& files);
+    static std::shared_ptr<TemplAtlas> open(const std::filesystem::path& path);
+
+    // 返回的 cv::Mat 只在图集存在期间有效，且不可写入
+    const std::unordered_map<std::string, cv::Mat>& templs() const noexcept { return m_templs; }
+
+private:
+    // 删掉最久没用过的图集
+    static void prune(const std::filesystem::path& dir);
+
+    static constexpr uint32_t FormatVersion = 1;
+    static constexpr size_t DataAlignment = 64;
+    static constexpr size_t MaxAtlasFiles = 8;
+
+    utils::file_mapping m_mapping;
+    std::unordered_map<std::string, cv::Mat> m_templs;
+};
+} // namespace asst
@@ -21,6 +21,7 @@ bool asst::TemplResource::load(const std::filesystem::path& path)
 #ifdef ASST_DEBUG
     bool some_file_not_exists = false;
 #endif
+    std::vector<std::pair<std::string, std::filesystem::path>> found;
     for (const std::string& name : m_load_required) {
         std::filesystem::path filepath(path / asst::utils::path(name));
         if (!filepath.has_extension()) {
@@ -31,8 +32,10 @@ bool asst::TemplResource::load(const std::filesystem::path& path)
             if (auto path_iter = m_templ_paths.find(name);
                 path_iter == m_templ_paths.end() || path_iter->second != filepath) {
                 m_templs.erase(name);
+                m_atlas_templs.erase(name);
                 m_templ_paths.insert_or_assign(name, filepath);
             }
+            found.emplace_back(name, std::move(filepath));
         }
         else if (m_templ_paths.contains(name)) {
             continue;
@@ -50,12 +53,48 @@ bool asst::TemplResource::load(const std::filesystem::path& path)
     if (some_file_not_exists) {
         return false;
     }
+#else
+    // DEBUG 模式下经常改图，直接读 png
+    load_atlas(found);
 #endif
     return true;
 }
 
+void asst::TemplResource::load_atlas(const std::vector<std::pair<std::string, std::filesystem::path>>& files)
+{
+    LogTraceFunction;
+
+    if (files.empty()) {
+        return;
+    }
+
+    const auto atlas_path = TemplAtlas::atlas_path(files);
+    auto atlas_iter = m_atlases.find(atlas_path);
+    if (atlas_iter == m_atlases.end()) {
+        auto atlas = TemplAtlas::open(atlas_path);
+        if (!atlas && TemplAtlas::build(atlas_path, files)) {
+            atlas = TemplAtlas::open(atlas_path);
+        }
+        if (!atlas) {
+            // 没有图集就退回到按需读取 png
+            Log.warn(__FUNCTION__, "atlas unavailable", atlas_path.lexically_relative(UserDir.get()));
+            return;
+        }
+        atlas_iter = m_atlases.emplace(atlas_path, std::move(atlas)).first;
+    }
+
+    for (const auto& [name, templ] : atlas_iter->second->templs()) {
+        m_templs.erase(name);
+        m_atlas_templs.insert_or_assign(name, templ);
+    }
+}
+
 const cv::Mat& asst::TemplResource::get_templ(const std::string& name)
 {
+    if (auto atlas_iter = m_atlas_templs.find(name); atlas_iter != m_atlas_templs.cend()) {
+        return atlas_iter->second;
+    }
+
     if (m_templs.find(name) == m_templs.cend()) {
         // Log.info(__FUNCTION__, "lazy load", name);
 
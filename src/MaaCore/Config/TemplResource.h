@@ -2,9 +2,12 @@
 
 #include "AbstractResource.h"
 
+#include <map>
+#include <memory>
 #include <unordered_map>
 #include <unordered_set>
 
+#include "TemplAtlas.h"
 #include "Utils/NoWarningCVMat.h"
 #include "Utils/SingletonHolder.hpp"
 
@@ -21,8 +24,15 @@ public:
     const cv::Mat& get_templ(const std::string& name);
 
 private:
+    // 把这次加载的模板换成图集里的，图集不存在时先生成
+    void load_atlas(const std::vector<std::pair<std::string, std::filesystem::path>>& files);
+
     std::unordered_set<std::string> m_load_required;
     std::unordered_map<std::string, cv::Mat> m_templs;
     std::unordered_map<std::string, std::filesystem::path> m_templ_paths;
+
+    // 图集里的模板指向映射的内存，外面可能还拿着浅拷贝，所以打开过的图集一直保留到进程退出
+    std::unordered_map<std::string, cv::Mat> m_atlas_templs;
+    std::map<std::filesystem::path, std::shared_ptr<TemplAtlas>> m_atlases;
 };
 }
@@ -121,6 +121,7 @@ std::optional<std::string> asst::AdbController::call_command(
     using namespace std::chrono_literals;
     using namespace std::chrono;
     // LogTraceScope(std::string(__FUNCTION__) + " | `" + cmd + "`");
+    ProfileScope("call_command", "io");
 
     std::string pipe_data;
     std::string sock_data;
@@ -732,7 +733,12 @@ bool asst::AdbController::screencap(
         }
     }
 
-    if (decode_func(data)) [[likely]] {
+    bool decoded = false;
+    {
+        ProfileScope("decode", "controller");
+        decoded = decode_func(data);
+    }
+    if (decoded) [[likely]] {
         if (m_adb.screencap_end_of_line == AdbProperty::ScreencapEndOfLine::UnknownYet) [[unlikely]] {
             Log.info("screencap_end_of_line is LF");
             m_adb.screencap_end_of_line = AdbProperty::ScreencapEndOfLine::LF;
@@ -26,6 +26,7 @@
 #include "PlayToolsController.h"
 
 #include "Common/AsstTypes.h"
+#include "TaskMetrics.h"
 #include "Utils/Logger.hpp"
 
 asst::Controller::Controller(const AsstCallback& callback, Assistant* inst) :
@@ -144,6 +145,7 @@ cv::Mat asst::Controller::get_resized_image_cache() const
         Log.error("image is empty");
         return { d_size, CV_8UC3 };
     }
+    ProfileScope("resize", "vision");
     cv::Mat resized_mat;
     cv::resize(m_cache_image, resized_mat, d_size, 0.0, 0.0, cv::INTER_AREA);
     return resized_mat;
@@ -163,12 +165,14 @@ bool asst::Controller::stop_game(const std::string& client_type)
 
 bool asst::Controller::click(const Point& p)
 {
+    ProfileScope("click", "controller");
     CHECK_EXIST(m_controller, false);
     return m_scale_proxy->click(p);
 }
 
 bool asst::Controller::click(const Rect& rect)
 {
+    ProfileScope("click", "controller");
     CHECK_EXIST(m_controller, false);
     return m_scale_proxy->click(rect);
 }
@@ -188,6 +192,7 @@ bool asst::Controller::swipe(
     double slope_out,
     bool with_pause)
 {
+    ProfileScope("swipe", "controller");
     CHECK_EXIST(m_controller, false);
     return m_scale_proxy->swipe(p1, p2, duration, extra_swipe, slope_in, slope_out, with_pause);
 }
@@ -201,6 +206,7 @@ bool asst::Controller::swipe(
     double slope_out,
     bool with_pause)
 {
+    ProfileScope("swipe", "controller");
     CHECK_EXIST(m_controller, false);
     return m_scale_proxy->swipe(r1, r2, duration, extra_swipe, slope_in, slope_out, with_pause);
 }
@@ -386,7 +392,13 @@ cv::Mat asst::Controller::get_image_cache() const
 
 bool asst::Controller::screencap(bool allow_reconnect)
 {
+    ProfileScope("screencap", "controller");
     CHECK_EXIST(m_controller, false);
+    MetricsTimer timer;
     std::unique_lock<std::shared_mutex> image_lock(m_image_mutex);
-    return m_controller->screencap(m_cache_image, allow_reconnect);
+    bool ret = m_controller->screencap(m_cache_image, allow_reconnect);
+    if (auto metrics_ptr = metrics()) {
+        metrics_ptr->add_screencap(timer.elapsed());
+    }
+    return ret;
 }
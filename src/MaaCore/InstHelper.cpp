@@ -20,6 +20,11 @@ std::shared_ptr<asst::Status> asst::InstHelper::status() const
     return m_inst ? m_inst->status() : nullptr;
 }
 
+std::shared_ptr<asst::TaskMetrics> asst::InstHelper::metrics() const
+{
+    return m_inst ? m_inst->metrics() : nullptr;
+}
+
 bool asst::InstHelper::need_exit() const
 {
     return m_inst != nullptr && m_inst->need_exit();
@@ -35,6 +40,7 @@ bool asst::InstHelper::sleep(unsigned millisecond) const
         return true;
     }
     Log.trace("ready to sleep", millisecond);
+    ProfileScope("sleep", "sleep");
     auto millisecond_ms = std::chrono::milliseconds(millisecond);
     auto interval = std::chrono::milliseconds(std::min(millisecond, 5000U));
 
@@ -8,6 +8,7 @@ namespace asst
 class Assistant;
 class Controller;
 class Status;
+class TaskMetrics;
 
 class InstHelper
 {
@@ -20,6 +21,7 @@ public:
 
     std::shared_ptr<Controller> ctrler() const;
     std::shared_ptr<Status> status() const;
+    std::shared_ptr<TaskMetrics> metrics() const;
     bool need_exit() const;
     bool sleep(unsigned millisecond) const;
 
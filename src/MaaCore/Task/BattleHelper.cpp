@@ -32,7 +32,7 @@ bool asst::BattleHelper::set_stage_name(const std::string& name)
 {
     LogTraceFunction;
 
-    if (auto result = Tile.find(name); !result || !json::open(result->second)) {
+    if (!TilePack::find_level(name)) {
         return false;
     }
     m_stage_name = name;
@@ -56,17 +56,19 @@ void asst::BattleHelper::clear()
     m_cur_deployment_opers.clear();
     m_battlefield_opers.clear();
     m_used_tiles.clear();
+    m_frame_watcher.clear();
 }
 
 bool asst::BattleHelper::calc_tiles_info(const std::string& stage_name, double shift_x, double shift_y)
 {
     LogTraceFunction;
 
-    if (auto result = Tile.find(stage_name); !result || !json::open(result->second)) {
+    auto level_opt = TilePack::find_level(stage_name);
+    if (!level_opt) {
         return false;
     }
 
-    m_map_data = TilePack::find_level(stage_name).value_or(Map::Level {});
+    m_map_data = std::move(*level_opt);
     auto calc_result = TilePack::calc(stage_name, shift_x, shift_y);
     m_normal_tile_info = std::move(calc_result.normal_tile_info);
     m_side_tile_info = std::move(calc_result.side_tile_info);
@@ -95,6 +97,19 @@ bool asst::BattleHelper::abandon()
     return ProcessTask(this_task(), { "RoguelikeBattleExitBegin" }).run();
 }
 
+cv::Mat asst::BattleHelper::get_battle_frame(std::chrono::milliseconds idle_interval)
+{
+    cv::Mat image = m_inst_helper.ctrler()->get_image();
+    if (!m_frame_watcher.frame_changed(image) && !m_inst_helper.need_exit()) {
+        // 暂停、剧情对话之类的时候画面是静止的，歇一会再截
+        LogDebugLazy("Frame not changed, sleeping");
+        std::this_thread::sleep_for(idle_interval);
+        image = m_inst_helper.ctrler()->get_image();
+        m_frame_watcher.frame_changed(image);
+    }
+    return image;
+}
+
 bool asst::BattleHelper::update_deployment(bool init, const cv::Mat& reusable, bool need_oper_cost)
 {
     LogTraceFunction;
@@ -106,6 +121,13 @@ bool asst::BattleHelper::update_deployment(bool init, const cv::Mat& reusable, b
 
     cv::Mat image = init || reusable.empty() ? m_inst_helper.ctrler()->get_image() : reusable;
 
+    static const Rect deployment_roi = Task.get("BattleFrameDeployment")->roi;
+    const bool deployment_changed = m_frame_watcher.region_changed("Deployment", image, deployment_roi);
+    if (!init && !need_oper_cost && !deployment_changed) {
+        // 部署栏没变化，干员、费用够不够、冷却都和上次一样
+        return check_in_battle(image);
+    }
+
     if (init) {
         auto draw_future = std::async(std::launch::async, [&]() { save_map(image); });
     }
@@ -121,6 +143,7 @@ bool asst::BattleHelper::update_deployment(bool init, const cv::Mat& reusable, b
     }
     auto oper_result_opt = oper_analyzer.analyze();
     if (!oper_result_opt) {
+        m_frame_watcher.invalidate("Deployment");
         check_in_battle(image);
         return false;
     }
@@ -183,11 +206,36 @@ bool asst::BattleHelper::update_deployment(bool init, const cv::Mat& reusable, b
                 is_analyzed = true;
             }
         }
+        static constexpr size_t NearestCount = 8;
+        // 候选只是哈希挑出来的，真正的干员可能不在里面，这时候过了阈值的只是候选里最像的那个
+        // 冷却中的头像阈值低，更容易这样认错，所以只有明显匹配上、且明显比其他候选好的时候才用
+        static constexpr double NearestConfidentScore = 0.9;
+        static constexpr double NearestMinMargin = 0.05;
+        const auto& avatar_cache = AvatarCache.get_avatars(oper.role);
+        std::vector<std::string> nearest_names;
+        if (!is_analyzed) {
+            // 之前的干员都没匹配上，先用哈希从缓存里挑几个最像的来匹配
+            nearest_names = AvatarCache.nearest_avatars(oper.role, oper.avatar, NearestCount);
+            for (const auto& name : nearest_names) {
+                if (auto iter = avatar_cache.find(name); iter != avatar_cache.end()) {
+                    avatar_analyzer.append_templ(name, iter->second);
+                }
+            }
+            if (auto result_opt = nearest_names.empty() ? std::nullopt : avatar_analyzer.analyze();
+                result_opt && result_opt->score >= NearestConfidentScore &&
+                result_opt->score - result_opt->second_score >= NearestMinMargin) {
+                set_oper_name(oper, result_opt->templ_info.name);
+                remove_cooling_from_battlefield(oper);
+                is_analyzed = true;
+            }
+        }
         if (!is_analyzed) {
-            // 之前的干员都没匹配上，那就把所有的干员都加进去
+            // 还是没匹配上，那就把剩下的干员都加进去，在所有干员里取最好的
             // 可能的优化: 移除之前添加的模板
-            auto& avatar_cache = AvatarCache.get_avatars(oper.role);
             for (const auto& [name, avatar] : avatar_cache) {
+                if (ranges::find(nearest_names, name) != nearest_names.end()) {
+                    continue;
+                }
                 avatar_analyzer.append_templ(name, avatar);
             }
             if (avatar_analyzer.analyze()) {
@@ -270,6 +318,8 @@ bool asst::BattleHelper::update_deployment(bool init, const cv::Mat& reusable, b
         if (!unknown_opers.empty()) {
             cancel_oper_selection();
         }
+        // 点开过干员，部署栏的样子变过了，下次重新识别
+        m_frame_watcher.invalidate("Deployment");
 
         image = m_inst_helper.ctrler()->get_image();
     }
@@ -316,6 +366,8 @@ cv::Mat asst::BattleHelper::get_top_view(const cv::Mat& cam_img, bool side)
 bool asst::BattleHelper::update_kills(const cv::Mat& reusable)
 {
     cv::Mat image = reusable.empty() ? m_inst_helper.ctrler()->get_image() : reusable;
+
+    // 击杀数和费用不按画面变化跳过：只变了一位数字时缩略图可能看不出来，而这两个值一旦沿用旧的就会等错时机
     BattlefieldMatcher analyzer(image);
     analyzer.set_object_of_interest({ .kills = true });
     if (m_total_kills) {
@@ -332,6 +384,7 @@ bool asst::BattleHelper::update_kills(const cv::Mat& reusable)
 bool asst::BattleHelper::update_cost(const cv::Mat& reusable)
 {
     cv::Mat image = reusable.empty() ? m_inst_helper.ctrler()->get_image() : reusable;
+
     BattlefieldMatcher analyzer(image);
     analyzer.set_object_of_interest({ .costs = true });
     auto result_opt = analyzer.analyze();
@@ -609,6 +662,7 @@ bool asst::BattleHelper::use_all_ready_skill(const cv::Mat& reusable)
 {
     // TODO: 可配置延迟时间
     static constexpr auto min_frame_interval = std::chrono::milliseconds(1500);
+    static const Rect skill_roi_move = Task.get("BattleSkillReady")->rect_move;
 
     bool used = false;
     const auto now = std::chrono::steady_clock::now();
@@ -622,6 +676,15 @@ bool asst::BattleHelper::use_all_ready_skill(const cv::Mat& reusable)
             continue;
         }
 
+        // 技能图标附近没变化的话，和上次识别的结果一样，不用再跑一遍
+        const std::string skill_key = "Skill_" + name;
+        if (auto iter = m_normal_tile_info.find(loc); iter != m_normal_tile_info.end()) {
+            const Rect skill_roi = Rect(iter->second.pos.x, iter->second.pos.y, 0, 0).move(skill_roi_move);
+            if (!m_frame_watcher.region_changed(skill_key, image, skill_roi)) {
+                continue;
+            }
+        }
+
         if (!is_skill_ready(loc, image)) {
             continue;
         }
@@ -633,11 +696,14 @@ bool asst::BattleHelper::use_all_ready_skill(const cv::Mat& reusable)
                 name,
                 "use skill too fast, interval time:",
                 std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(interval).count()) + " ms");
+            // 技能还亮着，画面不会再变了，下一帧还得再看一次
+            m_frame_watcher.invalidate(skill_key);
             continue;
         }
 
         // 识别到了，但点进去发现没有。一般来说是识别错了
         if (!use_skill(loc, false)) {
+            m_frame_watcher.invalidate(skill_key);
             Log.warn("Skill", name, "is not ready");
             constexpr int MaxRetry = 3;
             if (++retry >= MaxRetry) {
@@ -8,7 +8,9 @@
 #include "Utils/NoWarningCVMat.h"
 #include "Utils/Platform.hpp"
 #include "Utils/WorkingDir.hpp"
+#include "Vision/Battle/BattleFrameWatcher.h"
 
+#include <chrono>
 #include <filesystem>
 #include <map>
 
@@ -37,6 +39,10 @@ protected:
     bool speed_up();
     bool abandon();
 
+    // 战斗中循环用的截图：画面整个都没变化时歇 idle_interval 再截一张，静止的时候不用一直空转
+    cv::Mat get_battle_frame(std::chrono::milliseconds idle_interval = std::chrono::milliseconds(100));
+
+    // 部署栏的画面和上次识别时相比没变化时，直接沿用上次的结果
     bool update_deployment(bool init = false, const cv::Mat& reusable = cv::Mat(), bool need_oper_cost = false);
     bool update_kills(const cv::Mat& reusable = cv::Mat());
     bool update_cost(const cv::Mat& reusable = cv::Mat());
@@ -106,6 +112,8 @@ protected:
     std::map<std::string, Point> m_battlefield_opers;
     std::map<Point, std::string> m_used_tiles;
 
+    BattleFrameWatcher m_frame_watcher;
+
 private:
     InstHelper m_inst_helper;
 };
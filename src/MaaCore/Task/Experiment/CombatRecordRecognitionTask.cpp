@@ -7,16 +7,141 @@
 #include "Utils/Logger.hpp"
 #include "Utils/NoWarningCV.h"
 #include "Utils/Ranges.hpp"
+#include "Config/OnnxSessions.h"
 #include "Vision/Battle/BattleFormationAnalyzer.h"
+#include "Vision/Battle/BattleFrameWatcher.h"
 #include "Vision/Battle/BattlefieldClassifier.h"
 #include "Vision/Battle/BattlefieldDetector.h"
 #include "Vision/Battle/BattlefieldMatcher.h"
 #include "Vision/BestMatcher.h"
 #include "Vision/RegionOCRer.h"
 
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 
+namespace
+{
+// 解码线程和识别线程之间的有界队列，识别跟不上的时候解码先等着，免得解出来的帧把内存占满
+template <typename T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(size_t capacity) :
+        m_capacity(capacity)
+    {
+    }
+
+    bool push(T value)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_not_full.wait(lock, [&]() { return m_closed || m_queue.size() < m_capacity; });
+        if (m_closed) {
+            return false;
+        }
+        m_queue.emplace(std::move(value));
+        m_not_empty.notify_one();
+        return true;
+    }
+
+    // 关闭之后还会把剩下的取完，取完了返回 std::nullopt
+    std::optional<T> pop()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_not_empty.wait(lock, [&]() { return m_closed || !m_queue.empty(); });
+        if (m_queue.empty()) {
+            return std::nullopt;
+        }
+        T value = std::move(m_queue.front());
+        m_queue.pop();
+        m_not_full.notify_one();
+        return value;
+    }
+
+    void close()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_closed = true;
+        m_not_full.notify_all();
+        m_not_empty.notify_all();
+    }
+
+private:
+    size_t m_capacity = 0;
+    bool m_closed = false;
+    std::queue<T> m_queue;
+    std::mutex m_mutex;
+    std::condition_variable m_not_full;
+    std::condition_variable m_not_empty;
+};
+
+// 各个片段处理到哪一步了，后面的步骤可以等前面的
+class ClipStates
+{
+public:
+    enum class State
+    {
+        Pending,
+        Decoded,  // 帧都解码好了
+        Detected, // 场上干员识别完了，后一个片段可以拿来比较了
+        Done,
+        Failed,
+    };
+
+    explicit ClipStates(size_t size) :
+        m_states(size, State::Pending)
+    {
+    }
+
+    void set(size_t index, State state)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_states[index] = state;
+        m_cv.notify_all();
+    }
+
+    // 等到 index 至少到了 state 这一步，失败了或者整体停止了也会返回
+    State wait(size_t index, State state)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [&]() { return m_stopped || m_states[index] >= state; });
+        return m_states[index];
+    }
+
+    // 同上，但最多等 timeout，等的一方还要顾着别的退出条件时用
+    State wait_for(size_t index, State state, std::chrono::milliseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait_for(lock, timeout, [&]() { return m_stopped || m_states[index] >= state; });
+        return m_states[index];
+    }
+
+    void stop()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_stopped = true;
+        m_cv.notify_all();
+    }
+
+    bool stopped()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return m_stopped;
+    }
+
+private:
+    std::vector<State> m_states;
+    bool m_stopped = false;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+};
+}
+
 bool asst::CombatRecordRecognitionTask::set_video_path(const std::filesystem::path& path)
 {
     if (!std::filesystem::exists(path)) {
@@ -72,20 +197,9 @@ bool asst::CombatRecordRecognitionTask::_run()
         return false;
     }
 
-    ClipInfo* pre_valid = nullptr;
-    for (auto iter = m_clips.begin(); iter != m_clips.end(); ++iter) {
-        auto& clip = *iter;
-
-        if (!clip.deployment_changed && iter != m_clips.begin()) {
-            compare_skill(clip, *(iter - 1));
-            continue;
-        }
-
-        if (!analyze_clip(clip, pre_valid)) {
-            Log.error(__FUNCTION__, "failed to analyze clip");
-            return false;
-        }
-        pre_valid = &clip;
+    if (!analyze_clips()) {
+        Log.error(__FUNCTION__, "failed to analyze clip");
+        return false;
     }
 
     Log.info("full copilot json", m_copilot_json.to_string());
@@ -328,6 +442,9 @@ bool asst::CombatRecordRecognitionTask::slice_video()
     int latest_kills = -1;
     int total_kills = -1;
 
+    BattleFrameWatcher frame_watcher;
+    bool pre_in_battle = false;
+
     auto battle_over = [&]() {
         if (m_clips.empty()) {
             return;
@@ -355,6 +472,12 @@ bool asst::CombatRecordRecognitionTask::slice_video()
         }
         cv::resize(frame, frame, cv::Size(), m_scale, m_scale, cv::INTER_AREA);
 
+        // 画面和上一帧几乎一样（暂停、子弹时间之类的），识别结果也会一样，还在战斗中的话这一帧什么都不用做
+        const bool frame_changed = frame_watcher.frame_changed(frame);
+        if (!frame_changed && pre_in_battle) {
+            continue;
+        }
+
         BattlefieldMatcher analyzer(frame);
         analyzer.set_object_of_interest({
             .deployment = true,
@@ -365,6 +488,7 @@ bool asst::CombatRecordRecognitionTask::slice_video()
         analyzer.set_total_kills_prompt(total_kills);
         auto result_opt = analyzer.analyze();
         show_img(analyzer);
+        pre_in_battle = result_opt.has_value();
 
         if (!result_opt) {
             battle_over();
@@ -487,20 +611,190 @@ bool asst::CombatRecordRecognitionTask::slice_video()
     return true;
 }
 
-bool asst::CombatRecordRecognitionTask::analyze_clip(ClipInfo& clip, ClipInfo* pre_clip_ptr)
+bool asst::CombatRecordRecognitionTask::analyze_clips()
 {
     LogTraceFunction;
+    callback(AsstMsg::SubTaskStart, basic_info_with_what("AnalyzeClips"));
 
-    if (!detect_operators(clip, pre_clip_ptr)) {
-        return false;
+    using State = ClipStates::State;
+    constexpr size_t NPos = std::numeric_limits<size_t>::max();
+
+    // 部署区有变化的片段要识别场上干员，和它前一个这样的片段比较；其他的只比较技能
+    std::vector<bool> need_detect(m_clips.size(), false);
+    std::vector<size_t> pre_detect_index(m_clips.size(), NPos);
+    for (size_t i = 0, pre_index = NPos; i < m_clips.size(); ++i) {
+        if (i != 0 && !m_clips[i].deployment_changed) {
+            continue;
+        }
+        need_detect[i] = true;
+        pre_detect_index[i] = pre_index;
+        pre_index = i;
     }
-    if (!classify_direction(clip, pre_clip_ptr)) {
-        return false;
+
+    // 模型是懒加载的，不能让几个线程同时去加载
+    OnnxSessions::get_instance().get("operators_det");
+    OnnxSessions::get_instance().get("deploy_direction_cls");
+
+    const size_t thread_count = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, 8);
+    BoundedQueue<size_t> detect_queue(thread_count);
+    ClipStates states(m_clips.size());
+
+    // 线程里的异常要自己接住，标成失败。不然片段的状态停在半路，等它的线程就一直等下去了
+    auto decode_future = std::async(std::launch::async, [&]() {
+        size_t i = 0;
+        try {
+            for (; i < m_clips.size() && !states.stopped(); ++i) {
+                if (!read_clip_frames(m_clips[i], !need_detect[i])) {
+                    states.set(i, State::Failed);
+                    break;
+                }
+                if (!need_detect[i]) {
+                    states.set(i, State::Done);
+                    continue;
+                }
+                states.set(i, State::Decoded);
+                if (!detect_queue.push(i)) {
+                    break;
+                }
+            }
+        }
+        catch (const std::exception& e) {
+            Log.error(__FUNCTION__, "decode clip", i, "exception:", e.what());
+            states.set(i, State::Failed);
+        }
+        detect_queue.close();
+    });
+
+    std::vector<std::future<void>> detect_futures;
+    for (size_t t = 0; t < thread_count; ++t) {
+        detect_futures.emplace_back(std::async(std::launch::async, [&]() {
+            // 按顺序取的，前一个片段一定已经有线程在识别了，等它不会死锁
+            while (auto index_opt = detect_queue.pop()) {
+                const size_t i = *index_opt;
+                ClipInfo& clip = m_clips[i];
+                try {
+                    if (states.stopped() || !detect_operators(clip)) {
+                        states.set(i, State::Failed);
+                        continue;
+                    }
+                    states.set(i, State::Detected);
+
+                    const ClipInfo* pre_clip_ptr = nullptr;
+                    if (const size_t pre_index = pre_detect_index[i]; pre_index != NPos) {
+                        const State pre_state = states.wait(pre_index, State::Detected);
+                        if (pre_state != State::Detected && pre_state != State::Done) {
+                            states.set(i, State::Failed);
+                            continue;
+                        }
+                        pre_clip_ptr = &m_clips[pre_index];
+                    }
+                    const bool classified = classify_direction(clip, pre_clip_ptr);
+                    clip.random_frames.clear();
+                    clip.random_frames_changed.clear();
+                    states.set(i, classified ? State::Done : State::Failed);
+                }
+                catch (const std::exception& e) {
+                    Log.error(__FUNCTION__, "detect clip", i, "exception:", e.what());
+                    states.set(i, State::Failed);
+                }
+            }
+        }));
     }
-    if (!process_changes(clip, pre_clip_ptr)) {
-        return false;
+
+    bool ret = true;
+    ClipInfo* pre_valid = nullptr;
+    try {
+        for (size_t i = 0; i < m_clips.size(); ++i) {
+            // 回调都在当前线程里发；等的时候也要能响应停止
+            constexpr auto WaitInterval = std::chrono::milliseconds(100);
+            State state = states.wait_for(i, State::Done, WaitInterval);
+            while (state < State::Done && !need_exit()) {
+                state = states.wait_for(i, State::Done, WaitInterval);
+            }
+            if (need_exit()) {
+                ret = false;
+                break;
+            }
+            if (state != State::Done) {
+                Log.error(__FUNCTION__, "clip", i, "failed");
+                callback(AsstMsg::SubTaskError, basic_info_with_what("DetectOperators"));
+                ret = false;
+                break;
+            }
+            ClipInfo& clip = m_clips[i];
+            if (!need_detect[i]) {
+                compare_skill(clip, m_clips[i - 1]);
+            }
+            else if (process_changes(clip, pre_valid)) {
+                pre_valid = &clip;
+            }
+            else {
+                ret = false;
+                break;
+            }
+            clip.skill_frame = cv::Mat();
+
+            auto progress_info = basic_info_with_what("AnalyzeClips");
+            progress_info["details"]["current"] = i + 1;
+            progress_info["details"]["total"] = m_clips.size();
+            callback(AsstMsg::SubTaskExtraInfo, progress_info);
+        }
+    }
+    catch (const std::exception& e) {
+        Log.error(__FUNCTION__, "exception:", e.what());
+        ret = false;
+    }
+
+    // 不管怎么结束的，都让解码和识别线程尽快退出，再等它们结束
+    states.stop();
+    detect_queue.close();
+    decode_future.get();
+    for (auto& future : detect_futures) {
+        future.get();
+    }
+
+    callback(ret ? AsstMsg::SubTaskCompleted : AsstMsg::SubTaskError, basic_info_with_what("AnalyzeClips"));
+    return ret;
+}
+
+bool asst::CombatRecordRecognitionTask::read_clip_frames(ClipInfo& clip, bool for_skill)
+{
+    if (for_skill) {
+        // 有些干员明明点完技能了，但图标还会持续几百毫秒才消失
+        // 所以这里要跳过一段时间
+        constexpr int skip_ms = 500;
+        size_t cls_begin = clip.start_frame_index + static_cast<size_t>(skip_ms * m_video_fps / 1000.0);
+        if (cls_begin > clip.end_frame_index) {
+            Log.warn("skip too much");
+            cls_begin = clip.start_frame_index + (clip.end_frame_index - clip.start_frame_index) / 2;
+        }
+        seek_frame(cls_begin);
+        // 读不到的话留空，由 compare_skill 报错，不影响别的片段
+        clip.skill_frame = read_frame();
+        return true;
     }
 
+    const size_t frame_count = clip.end_frame_index - clip.start_frame_index;
+
+    constexpr size_t OperDetSamplingCount = 20;
+    const size_t skip_count =
+        frame_count > (OperDetSamplingCount + 1) ? frame_count / (OperDetSamplingCount + 1) - 1 : 0;
+
+    const size_t det_begin = clip.start_frame_index + skip_count;
+    const size_t det_end = clip.end_frame_index - skip_count;
+
+    seek_frame(det_begin);
+
+    BattleFrameWatcher frame_watcher;
+    for (size_t i = det_begin; i <= det_end; i += skip_frames(skip_count) + 1) {
+        cv::Mat frame = read_frame();
+        if (frame.empty()) {
+            Log.error(i, "frame is empty");
+            return false;
+        }
+        clip.random_frames_changed.emplace_back(frame_watcher.frame_changed(frame));
+        clip.random_frames.emplace_back(std::move(frame));
+    }
     return true;
 }
 
@@ -524,25 +818,13 @@ bool asst::CombatRecordRecognitionTask::compare_skill(ClipInfo& clip, ClipInfo&
         return true;
     }
 
-    // 有些干员明明点完技能了，但图标还会持续几百毫秒才消失
-    // 所以这里要跳过一段时间
-    constexpr int skip_ms = 500;
-    size_t cls_begin = clip.start_frame_index + static_cast<size_t>(skip_ms * m_video_fps / 1000.0);
-    if (cls_begin > clip.end_frame_index) {
-        Log.warn("skip too much");
-        cls_begin = clip.start_frame_index + (clip.end_frame_index - clip.start_frame_index) / 2;
-    }
-    const size_t begin_skip = cls_begin - static_cast<size_t>(m_video_ptr->get(cv::CAP_PROP_POS_FRAMES));
-    skip_frames(begin_skip);
-
-    cv::Mat frame;
-    *m_video_ptr >> frame;
+    // 用的是解码线程按 read_clip_frames 里的时间点取好的帧
+    const cv::Mat& frame = clip.skill_frame;
     if (frame.empty()) {
         Log.error("frame is empty");
         callback(AsstMsg::SubTaskError, basic_info_with_what("CompSkill"));
         return false;
     }
-    cv::resize(frame, frame, cv::Size(), m_scale, m_scale, cv::INTER_AREA);
     analyzer.set_image(frame);
     bool cur_ready = analyzer.analyze()->skill_ready.ready;
 
@@ -562,58 +844,40 @@ bool asst::CombatRecordRecognitionTask::compare_skill(ClipInfo& clip, ClipInfo&
     return true;
 }
 
-bool asst::CombatRecordRecognitionTask::detect_operators(ClipInfo& clip, [[maybe_unused]] ClipInfo* pre_clip_ptr)
+bool asst::CombatRecordRecognitionTask::detect_operators(ClipInfo& clip)
 {
     LogTraceFunction;
 
-    callback(AsstMsg::SubTaskStart, basic_info_with_what("DetectOperators"));
-
-    const size_t frame_count = clip.end_frame_index - clip.start_frame_index;
-
     /* detect operators on the battefield */
     using DetectionResult = std::unordered_set<Point>;
     std::unordered_map<DetectionResult, size_t, ContainerHasher<DetectionResult>> oper_det_samping;
     const Rect det_box_move = Task.get("BattleOperBoxRectMove")->rect_move;
 
-    constexpr size_t OperDetSamplingCount = 20;
-    const size_t skip_count =
-        frame_count > (OperDetSamplingCount + 1) ? frame_count / (OperDetSamplingCount + 1) - 1 : 0;
-
-    const size_t det_begin = clip.start_frame_index + skip_count;
-    const size_t det_end = clip.end_frame_index - skip_count;
-
-    const size_t begin_skip = det_begin - static_cast<size_t>(m_video_ptr->get(cv::CAP_PROP_POS_FRAMES));
-    skip_frames(begin_skip);
-
-    for (size_t i = det_begin; i <= det_end; i += skip_frames(skip_count) + 1) {
-        cv::Mat frame;
-        *m_video_ptr >> frame;
-        if (frame.empty()) {
-            Log.error(i, "frame is empty");
-            callback(AsstMsg::SubTaskError, basic_info_with_what("DetectOperators"));
-            return false;
+    // 在识别线程里跑的，不能 show_img
+    DetectionResult cur_locations;
+    for (size_t i = 0; i < clip.random_frames.size(); ++i) {
+        if (i != 0 && !clip.random_frames_changed[i]) {
+            // 和前一张采样帧一样，结果也一样
+            oper_det_samping[cur_locations] += 1;
+            continue;
         }
 
-        cv::resize(frame, frame, cv::Size(), m_scale, m_scale, cv::INTER_AREA);
-        BattlefieldDetector analyzer(frame);
+        BattlefieldDetector analyzer(clip.random_frames[i]);
         analyzer.set_object_of_interest({ .operators = true });
         auto result_opt = analyzer.analyze();
-        show_img(analyzer);
 
-        DetectionResult cur_locations;
+        cur_locations.clear();
         auto tiles = m_normal_tile_info | views::values;
         for (const auto& box : result_opt->operators) {
             Rect rect = box.rect.move(det_box_move);
             auto iter = ranges::find_if(tiles, [&](const TilePack::TileInfo& t) { return rect.include(t.pos); });
             if (iter == tiles.end()) {
-                Log.warn(i, __FUNCTION__, "no pos", box.rect.to_string(), rect);
+                Log.warn(clip.start_frame_index, i, __FUNCTION__, "no pos", box.rect.to_string(), rect);
                 continue;
             }
             cur_locations.emplace((*iter).loc);
         }
-        oper_det_samping[std::move(cur_locations)] += 1;
-
-        clip.random_frames.emplace_back(frame); // for classify_direction
+        oper_det_samping[cur_locations] += 1;
     }
 
     /* 取众数 */
@@ -622,7 +886,6 @@ bool asst::CombatRecordRecognitionTask::detect_operators(ClipInfo& clip, [[maybe
     });
     if (oper_det_iter == oper_det_samping.end()) {
         Log.error(__FUNCTION__, "oper_det_samping is empty");
-        callback(AsstMsg::SubTaskError, basic_info_with_what("DetectOperators"));
         return false;
     }
 
@@ -630,17 +893,15 @@ bool asst::CombatRecordRecognitionTask::detect_operators(ClipInfo& clip, [[maybe
         clip.battlefield.emplace(loc, BattlefieldOper {});
     }
 
-    callback(AsstMsg::SubTaskCompleted, basic_info_with_what("DetectOperators"));
     return true;
 }
 
-bool asst::CombatRecordRecognitionTask::classify_direction(ClipInfo& clip, ClipInfo* pre_clip_ptr)
+bool asst::CombatRecordRecognitionTask::classify_direction(ClipInfo& clip, const ClipInfo* pre_clip_ptr)
 {
     LogTraceFunction;
 
     if (!pre_clip_ptr) {
         Log.info("first clip, skip");
-        callback(AsstMsg::SubTaskCompleted, basic_info_with_what("ClassifyDirection"));
         return true;
     }
 
@@ -654,22 +915,26 @@ bool asst::CombatRecordRecognitionTask::classify_direction(ClipInfo& clip, ClipI
     if (newcomer.empty()) {
         return true;
     }
-    callback(AsstMsg::SubTaskStart, basic_info_with_what("ClassifyDirection"));
 
     /* classify direction */
     using Raw = BattlefieldClassifier::DeployDirectionResult::Raw;
     constexpr size_t ClsSize = BattlefieldClassifier::DeployDirectionResult::ClsSize;
     std::unordered_map<Point, Raw> dir_cls_sampling;
-
-    for (const cv::Mat& frame : clip.random_frames) {
-        BattlefieldClassifier analyzer(frame);
-        analyzer.set_object_of_interest({ .skill_ready = false, .deploy_direction = true });
-        for (const auto& loc : newcomer) {
-            analyzer.set_base_point(m_normal_tile_info.at(loc).pos);
-            auto result_opt = analyzer.analyze();
-            show_img(analyzer);
-            for (size_t i = 0; i < ClsSize; ++i) {
-                dir_cls_sampling[loc][i] += result_opt->deploy_direction.raw[i];
+    std::unordered_map<Point, Raw> cur_raws;
+
+    for (size_t i = 0; i < clip.random_frames.size(); ++i) {
+        // 和前一张采样帧一样的就沿用前一张的结果
+        if (i == 0 || clip.random_frames_changed[i]) {
+            BattlefieldClassifier analyzer(clip.random_frames[i]);
+            analyzer.set_object_of_interest({ .skill_ready = false, .deploy_direction = true });
+            for (const auto& loc : newcomer) {
+                analyzer.set_base_point(m_normal_tile_info.at(loc).pos);
+                cur_raws[loc] = analyzer.analyze()->deploy_direction.raw;
+            }
+        }
+        for (const auto& [loc, raw] : cur_raws) {
+            for (size_t j = 0; j < ClsSize; ++j) {
+                dir_cls_sampling[loc][j] += raw[j];
             }
         }
     }
@@ -677,10 +942,11 @@ bool asst::CombatRecordRecognitionTask::classify_direction(ClipInfo& clip, ClipI
     for (const auto& [loc, sampling] : dir_cls_sampling) {
         auto class_id = std::max_element(sampling.begin(), sampling.end()) - sampling.begin();
 
-        clip.battlefield[loc].direction = static_cast<battle::DeployDirection>(class_id);
-        clip.battlefield[loc].new_here = true;
+        // 后一个片段可能正在另一个线程里读 battlefield，这里不能用 operator[]
+        auto& oper = clip.battlefield.at(loc);
+        oper.direction = static_cast<battle::DeployDirection>(class_id);
+        oper.new_here = true;
     }
-    callback(AsstMsg::SubTaskCompleted, basic_info_with_what("ClassifyDirection"));
     return true;
 }
 
@@ -866,13 +1132,34 @@ json::object asst::CombatRecordRecognitionTask::analyze_action_condition(ClipInf
 
 size_t asst::CombatRecordRecognitionTask::skip_frames(size_t count)
 {
+    // 只 grab 不 retrieve，跳过的帧不用解码成图像
     for (size_t i = 0; i < count; ++i) {
-        cv::Mat ignore;
-        *m_video_ptr >> ignore;
+        m_video_ptr->grab();
     }
     return count;
 }
 
+void asst::CombatRecordRecognitionTask::seek_frame(size_t frame_index)
+{
+    const size_t cur_index = static_cast<size_t>(m_video_ptr->get(cv::CAP_PROP_POS_FRAMES));
+    if (frame_index >= cur_index) {
+        skip_frames(frame_index - cur_index);
+    }
+    else {
+        m_video_ptr->set(cv::CAP_PROP_POS_FRAMES, static_cast<double>(frame_index));
+    }
+}
+
+cv::Mat asst::CombatRecordRecognitionTask::read_frame()
+{
+    cv::Mat frame;
+    *m_video_ptr >> frame;
+    if (!frame.empty()) {
+        cv::resize(frame, frame, cv::Size(), m_scale, m_scale, cv::INTER_AREA);
+    }
+    return frame;
+}
+
 std::string asst::CombatRecordRecognitionTask::analyze_detail_page_oper_name(const cv::Mat& frame)
 {
     const auto& replace_task = Task.get<OcrTaskInfo>("CharsNameOcrReplace");
@@ -46,6 +46,8 @@ private:
         bool deployment_changed = true;
         std::unordered_map<Point, BattlefieldOper> battlefield;
         std::vector<cv::Mat> random_frames;
+        std::vector<bool> random_frames_changed; // 和前一张采样帧比画面有没有变，没变的直接沿用前一张的识别结果
+        cv::Mat skill_frame;                     // compare_skill 用的帧
         std::string ends_oper_name;
     };
 
@@ -55,14 +57,18 @@ private:
     bool slice_video();
     bool compare_skill(ClipInfo& clip, ClipInfo& pre_clip);
 
-    bool analyze_clip(ClipInfo& clip, ClipInfo* pre_clip_ptr);
-    bool detect_operators(ClipInfo& clip, ClipInfo* pre_clip_ptr);
-    bool classify_direction(ClipInfo& clip, ClipInfo* pre_clip_ptr);
+    // 一个线程按顺序解码各个片段要用的帧，多个线程并行识别场上干员和朝向，当前线程按片段顺序生成作业
+    bool analyze_clips();
+    bool read_clip_frames(ClipInfo& clip, bool for_skill);
+    bool detect_operators(ClipInfo& clip);
+    bool classify_direction(ClipInfo& clip, const ClipInfo* pre_clip_ptr);
     bool process_changes(ClipInfo& clip, ClipInfo* pre_clip_ptr);
     void ananlyze_deployment_names(ClipInfo& clip);
 
     json::object analyze_action_condition(ClipInfo& clip, ClipInfo* pre_clip_ptr);
     size_t skip_frames(size_t count);
+    void seek_frame(size_t frame_index);
+    cv::Mat read_frame();
 
     static std::string analyze_detail_page_oper_name(const cv::Mat& frame);
 
@@ -0,0 +1,192 @@
+#include "InfrastOptimizer.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include <calculator/calculator.hpp>
+
+#include "Status.h"
+#include "Utils/Logger.hpp"
+#include "Utils/Ranges.hpp"
+
+namespace
+{
+// 从效率降序的候选中挑选，分支限界
+struct SinglesSearch
+{
+    static constexpr double Epsilon = 1e-6;
+    // 正常情况下很快就能剪完，这里只是防止配置写得太奇怪的时候跑太久
+    static constexpr size_t MaxNodes = 100000;
+
+    std::vector<double> effs;                // 降序
+    std::vector<double> prefix;              // effs 的前缀和
+    std::vector<std::vector<size_t>> skills; // 每个候选的技能，稠密编号
+    std::vector<int> max_nums;               // 每个技能最多选几个
+    size_t max_count = 0;
+
+    std::vector<int> skill_nums;
+    std::vector<size_t> chosen;
+    double chosen_eff = 0;
+    std::vector<size_t> best;
+    double best_eff = 0;
+    size_t nodes = 0;
+
+    bool can_choose(size_t index) const
+    {
+        return asst::ranges::all_of(skills[index], [&](size_t skill) {
+            return skill_nums[skill] < max_nums[skill];
+        });
+    }
+
+    // 先选后不选，所以找到的第一个解就是原来贪心的结果，之后只会换成人数更多、或人数相同但效率更高的
+    // 人数优先，所以效率之和可能反而比贪心的低
+    void dfs(size_t index)
+    {
+        if (++nodes > MaxNodes) {
+            return;
+        }
+        if (chosen.size() > best.size() || (chosen.size() == best.size() && chosen_eff > best_eff + Epsilon)) {
+            best = chosen;
+            best_eff = chosen_eff;
+        }
+        if (chosen.size() == max_count || index == effs.size()) {
+            return;
+        }
+
+        // 剩下的全选上人数也比不过，或者人数只能打平而效率不可能更高，就不用再往下找了
+        const size_t remain = std::min(max_count - chosen.size(), effs.size() - index);
+        if (chosen.size() + remain < best.size()) {
+            return;
+        }
+        if (chosen.size() + remain == best.size() &&
+            chosen_eff + prefix[index + remain] - prefix[index] <= best_eff + Epsilon) {
+            return;
+        }
+
+        if (can_choose(index)) {
+            for (size_t skill : skills[index]) {
+                ++skill_nums[skill];
+            }
+            chosen.emplace_back(index);
+            chosen_eff += effs[index];
+
+            dfs(index + 1);
+
+            chosen_eff -= effs[index];
+            chosen.pop_back();
+            for (size_t skill : skills[index]) {
+                --skill_nums[skill];
+            }
+        }
+        dfs(index + 1);
+    }
+};
+}
+
+int asst::InfrastOptimizer::eval_formula(const std::string& formula, const Status& status)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    const Formula& compiled = compile(formula);
+    std::string cur_formula = compiled.texts.front();
+    for (size_t i = 0; i < compiled.status_keys.size(); ++i) {
+        auto status_opt = status.get_number(compiled.status_keys[i]);
+        const int64_t status_value = status_opt ? status_opt.value() : 0;
+        cur_formula += std::to_string(status_value);
+        cur_formula += compiled.texts[i + 1];
+    }
+
+    if (const int* cached = m_formula_results.get(cur_formula)) {
+        return *cached;
+    }
+    int result = calculator::eval(cur_formula);
+    m_formula_results.put(cur_formula, result);
+    return result;
+}
+
+const asst::InfrastOptimizer::Formula& asst::InfrastOptimizer::compile(const std::string& formula)
+{
+    if (auto iter = m_formulas.find(formula); iter != m_formulas.cend()) {
+        return iter->second;
+    }
+
+    Formula compiled;
+    size_t pos = 0;
+    while (true) {
+        size_t lp_pos = formula.find('[', pos);
+        size_t rp_pos = lp_pos == std::string::npos ? std::string::npos : formula.find(']', lp_pos);
+        if (rp_pos == std::string::npos) {
+            // 和原来一样，括号不成对的就原样留着交给 calculator 报错
+            compiled.texts.emplace_back(formula.substr(pos));
+            break;
+        }
+        compiled.texts.emplace_back(formula.substr(pos, lp_pos - pos));
+        compiled.status_keys.emplace_back(formula.substr(lp_pos + 1, rp_pos - lp_pos - 1));
+        pos = rp_pos + 1;
+    }
+    return m_formulas.emplace(formula, std::move(compiled)).first->second;
+}
+
+std::vector<size_t> asst::InfrastOptimizer::best_singles(
+    const std::vector<infrast::SkillsComb>& combs,
+    const std::string& product,
+    size_t max_count)
+{
+    LogTraceFunction;
+
+    // 同一批干员换班时经常会再算一遍，按候选的技能和效率缓存结果
+    std::string key = product + '\n' + std::to_string(max_count) + '\n';
+    for (const auto& comb : combs) {
+        std::vector<std::string> skill_ids;
+        skill_ids.reserve(comb.skills.size());
+        ranges::transform(comb.skills, std::back_inserter(skill_ids), std::mem_fn(&infrast::Skill::id));
+        ranges::sort(skill_ids);
+        for (const auto& id : skill_ids) {
+            key += id + ',';
+        }
+        key += std::to_string(comb.efficient.at(product)) + ';';
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (const auto* cached = m_singles_results.get(key)) {
+            return *cached;
+        }
+    }
+
+    std::vector<size_t> order(combs.size());
+    std::iota(order.begin(), order.end(), 0);
+    ranges::stable_sort(order, std::greater {}, [&](size_t index) { return combs[index].efficient.at(product); });
+
+    SinglesSearch search;
+    search.max_count = max_count;
+    search.prefix.emplace_back(0);
+    std::unordered_map<std::string, size_t> skill_ids;
+    for (size_t index : order) {
+        const auto& comb = combs[index];
+        const double eff = comb.efficient.at(product);
+        search.effs.emplace_back(eff);
+        search.prefix.emplace_back(search.prefix.back() + eff);
+
+        auto& skills = search.skills.emplace_back();
+        for (const auto& skill : comb.skills) {
+            auto [iter, inserted] = skill_ids.emplace(skill.id, skill_ids.size());
+            if (inserted) {
+                search.max_nums.emplace_back(skill.max_num);
+            }
+            skills.emplace_back(iter->second);
+        }
+    }
+    search.skill_nums.assign(search.max_nums.size(), 0);
+    search.dfs(0);
+    Log.trace(__FUNCTION__, "| searched nodes", search.nodes, "efficient", search.best_eff);
+
+    std::vector<size_t> result;
+    result.reserve(search.best.size());
+    ranges::transform(search.best, std::back_inserter(result), [&](size_t pos) { return order[pos]; });
+    ranges::sort(result);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_singles_results.put(key, result);
+    return result;
+}
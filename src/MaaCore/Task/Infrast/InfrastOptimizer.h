@@ -0,0 +1,49 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Common/AsstInfrastDef.h"
+#include "Utils/LruCache.hpp"
+#include "Utils/SingletonHolder.hpp"
+
+namespace asst
+{
+class Status;
+
+// 基建排班的计算：技能效率公式的求值，以及从可用干员中挑出效率之和最高的一组
+class InfrastOptimizer final : public SingletonHolder<InfrastOptimizer>
+{
+public:
+    virtual ~InfrastOptimizer() override = default;
+
+    // 计算形如 "[NumOfTrade] * 20" 的效率公式，方括号中是 Status 里的数值，没有的按 0 算
+    int eval_formula(const std::string& formula, const Status& status);
+
+    // 从 combs 中选出至多 max_count 个，每个技能被选中的次数不超过它的 max_num
+    // 先保证人数尽量多，人数相同时效率之和最高；返回在 combs 中的下标，升序
+    std::vector<size_t>
+        best_singles(const std::vector<infrast::SkillsComb>& combs, const std::string& product, size_t max_count);
+
+private:
+    friend class SingletonHolder<InfrastOptimizer>;
+
+    InfrastOptimizer() = default;
+
+    // 公式被方括号切成几段，求值时把状态值填回去即可，不用每次都重新找方括号
+    struct Formula
+    {
+        std::vector<std::string> texts; // 比 status_keys 多一段
+        std::vector<std::string> status_keys;
+    };
+
+    const Formula& compile(const std::string& formula);
+
+    std::mutex m_mutex;
+    std::unordered_map<std::string, Formula> m_formulas;
+    LruCache<std::string, int> m_formula_results { 256 };                // 代入状态值之后的公式 -> 结果
+    LruCache<std::string, std::vector<size_t>> m_singles_results { 32 }; // 可用干员及其效率 -> 选择结果
+};
+} // namespace asst
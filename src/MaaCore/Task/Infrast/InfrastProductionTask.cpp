@@ -3,11 +3,10 @@
 #include "Utils/Ranges.hpp"
 #include <algorithm>
 
-#include <calculator/calculator.hpp>
-
 #include "Config/Miscellaneous/InfrastConfig.h"
 #include "Config/TaskData.h"
 #include "Controller/Controller.h"
+#include "InfrastOptimizer.h"
 #include "Status.h"
 #include "Task/ProcessTask.h"
 #include "Utils/Logger.hpp"
@@ -16,6 +15,7 @@
 #include "Vision/Matcher.h"
 #include "Vision/MultiMatcher.h"
 #include "Vision/RegionOCRer.h"
+#include "Vision/ScrollTracker.h"
 
 asst::InfrastProductionTask& asst::InfrastProductionTask::set_uses_of_drone(std::string uses_of_drones) noexcept
 {
@@ -279,12 +279,19 @@ bool asst::InfrastProductionTask::opers_detect_with_swipe()
 {
     LogTraceFunction;
     m_all_available_opers.clear();
+    m_prev_page_opers.clear();
+
+    // 每次滑动的距离不到一页，前后两页重叠的干员不用再识别一遍
+    const Rect upper_roi = Task.get("InfrastSkillsUpper")->roi;
+    const Rect lower_roi = Task.get("InfrastSkillsLower")->roi;
+    const int list_height = lower_roi.y + lower_roi.height - upper_roi.y;
+    ScrollTracker tracker(Rect(upper_roi.x, upper_roi.y, upper_roi.width, list_height));
 
     while (true) {
         if (need_exit()) {
             return false;
         }
-        size_t num = opers_detect();
+        size_t num = opers_detect(&tracker);
         Log.trace("opers_detect return", num);
 
         if (num == 0) {
@@ -301,7 +308,7 @@ bool asst::InfrastProductionTask::opers_detect_with_swipe()
     return false;
 }
 
-size_t asst::InfrastProductionTask::opers_detect()
+size_t asst::InfrastProductionTask::opers_detect(ScrollTracker* tracker)
 {
     LogTraceFunction;
     const auto image = ctrler()->get_image();
@@ -309,8 +316,19 @@ size_t asst::InfrastProductionTask::opers_detect()
     InfrastOperImageAnalyzer oper_analyzer(image);
     oper_analyzer.set_to_be_calced(InfrastOperImageAnalyzer::ToBeCalced::All);
     oper_analyzer.set_facility(facility_name());
+    if (tracker && tracker->update(image)) {
+        std::vector<infrast::Oper> carried = m_prev_page_opers;
+        for (auto& oper : carried) {
+            oper.smiley.rect = *tracker->from_previous(oper.smiley.rect);
+        }
+        oper_analyzer.set_carried_opers(std::move(carried));
+    }
 
-    if (!oper_analyzer.analyze()) {
+    bool analyzed = oper_analyzer.analyze();
+    if (tracker) {
+        m_prev_page_opers = oper_analyzer.get_result();
+    }
+    if (!analyzed) {
         return 0;
     }
     const auto& cur_all_opers = oper_analyzer.get_result();
@@ -335,14 +353,15 @@ size_t asst::InfrastProductionTask::opers_detect()
             //--cur_available_num;
             continue;
         }
+        // 先比 hash，比技能集合便宜得多，列表很长的时候能省下大部分比较
         auto find_iter = ranges::find_if(m_all_available_opers, [&](const infrast::Oper& oper) -> bool {
-            if (oper.skills != cur_oper.skills) {
+            int dist = Hasher::hamming(cur_oper.face_hash, oper.face_hash);
+            if (dist >= face_hash_thres) {
                 return false;
             }
-            // 有可能是同一个干员，比一下hash
-            int dist = Hasher::hamming(cur_oper.face_hash, oper.face_hash);
-            Log.debug("opers_detect hash dist |", dist);
-            return dist < face_hash_thres;
+            // hash 很接近，有可能是同一个干员，再比一下技能
+            LogDebugLazy("opers_detect hash dist |", dist);
+            return oper.skills == cur_oper.skills;
         });
         // 如果两个的hash距离过小，则认为是同一个干员，不进行插入
         if (find_iter != m_all_available_opers.cend()) {
@@ -391,31 +410,12 @@ bool asst::InfrastProductionTask::optimal_calc()
         Log.trace(skill_str, comb.efficient.at(m_product));
     }
 
-    std::unordered_map<std::string, int> skills_num;
-    for (size_t i = 0; i != m_all_available_opers.size(); ++i) {
-        const auto& comb = all_available_combs.at(i);
-
-        bool out_of_num = false;
-        for (auto&& skill : comb.skills) {
-            if (skills_num[skill.id] >= skill.max_num) {
-                out_of_num = true;
-                break;
-            }
-        }
-        if (out_of_num) {
-            continue;
-        }
-
+    // 在技能数量的限制下，挑出效率之和最高的几个
+    auto& optimizer = InfrastOptimizer::get_instance();
+    for (size_t index : optimizer.best_singles(all_available_combs, m_product, cur_max_num_of_opers)) {
+        const auto& comb = all_available_combs.at(index);
         optimal_combs.emplace_back(comb);
-        max_efficient += all_available_combs.at(i).efficient.at(m_product);
-
-        for (auto&& skill : comb.skills) {
-            ++skills_num[skill.id];
-        }
-
-        if (optimal_combs.size() >= static_cast<size_t>(cur_max_num_of_opers)) {
-            break;
-        }
+        max_efficient += comb.efficient.at(m_product);
     }
 
     {
@@ -672,7 +672,7 @@ bool asst::InfrastProductionTask::opers_choose()
             {
                 auto avlb_iter = ranges::find_if(m_all_available_opers, [&](const infrast::Oper& lhs) -> bool {
                     int dist = Hasher::hamming(lhs.face_hash, find_iter->face_hash);
-                    Log.debug("opers_choose | face hash dist", dist);
+                    LogDebugLazy("opers_choose | face hash dist", dist);
                     return dist < face_hash_thres;
                 });
                 if (avlb_iter != m_all_available_opers.cend()) {
@@ -722,25 +722,7 @@ asst::infrast::SkillsComb
     infrast::SkillsComb comb(std::move(skills));
     // 根据正则，计算当前干员的实际效率
     for (auto&& [product, formula] : comb.efficient_regex) {
-        std::string cur_formula = formula;
-        for (size_t pos = 0; pos != std::string::npos;) {
-            pos = cur_formula.find('[', pos);
-            if (pos == std::string::npos) {
-                break;
-            }
-            size_t rp_pos = cur_formula.find(']', pos);
-            if (rp_pos == std::string::npos) {
-                break;
-                // TODO 报错！
-            }
-            std::string status_key = cur_formula.substr(pos + 1, rp_pos - pos - 1);
-            auto status_opt = status()->get_number(status_key);
-            const int64_t status_value = status_opt ? status_opt.value() : 0;
-            cur_formula.replace(pos, rp_pos - pos + 1, std::to_string(status_value));
-        }
-
-        int eff = calculator::eval(cur_formula);
-        comb.efficient[product] = eff;
+        comb.efficient[product] = InfrastOptimizer::get_instance().eval_formula(formula, *status());
     }
     return comb;
 }
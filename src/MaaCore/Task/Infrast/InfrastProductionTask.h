@@ -6,6 +6,8 @@
 
 namespace asst
 {
+class ScrollTracker;
+
 // 生产类设施的任务，适用于制造站、贸易站、控制中枢
 class InfrastProductionTask : public InfrastAbstractTask
 {
@@ -23,7 +25,8 @@ protected:
     bool facility_list_detect();
     bool opers_detect_with_swipe();
     // 返回当前页面的干员数 (可用?
-    size_t opers_detect();
+    // 传入 tracker 时，和上一次识别的页面重叠的干员会沿用上一次的结果
+    size_t opers_detect(ScrollTracker* tracker = nullptr);
     bool optimal_calc();
     bool opers_choose();
     bool use_drone();
@@ -35,6 +38,7 @@ protected:
     std::string m_uses_of_drones;
     int m_cur_num_of_locked_opers = 0;
     std::vector<infrast::Oper> m_all_available_opers;
+    std::vector<infrast::Oper> m_prev_page_opers; // 上一页识别到的干员，滑动时沿用结果用
     std::vector<infrast::SkillsComb> m_optimal_combs;
     std::vector<Rect> m_facility_list_tabs;
     size_t max_num_of_opers_per_page = 0;
@@ -15,105 +15,6 @@
 #include <algorithm>
 #include <regex>
 
-namespace asst::recruit_calc
-{
-// all combinations and their operator list, excluding empty set and 6-star operators while there is
-// no senior tag
-auto get_all_combs(
-    const std::vector<RecruitConfig::TagId>& tags,
-    const std::vector<Recruitment>& all_ops = RecruitData.get_all_opers())
-{
-    std::vector<RecruitCombs> rcs_with_single_tag;
-
-    {
-        rcs_with_single_tag.reserve(tags.size());
-        ranges::transform(tags, std::back_inserter(rcs_with_single_tag), [](const RecruitConfig::TagId& t) {
-            RecruitCombs result;
-            result.tags = { t };
-            result.min_level = 6;
-            result.max_level = 0;
-            result.avg_level = 0;
-            return result;
-        });
-
-        for (const auto& op : all_ops) {
-            for (auto& rc : rcs_with_single_tag) {
-                if (!op.has_tag(rc.tags.front())) {
-                    continue;
-                }
-                rc.opers.push_back(op);
-                rc.min_level = (std::min)(rc.min_level, op.level);
-                rc.max_level = (std::max)(rc.max_level, op.level);
-                rc.avg_level += op.level;
-            }
-        }
-
-        for (auto& rc : rcs_with_single_tag) {
-            rc.avg_level /= static_cast<double>(rc.opers.size());
-            // intersection and union are based on sorted container
-            ranges::sort(rc.tags);
-            ranges::sort(rc.opers);
-        }
-    }
-
-    std::vector<RecruitCombs> result;
-    const size_t tag_size = tags.size();
-    result.reserve(tag_size * (tag_size * tag_size + 5) / 6); // C(size, 3) + C(size, 2) + C(size, 1)
-
-    // select one tag first
-    for (size_t i = 0; i < tag_size; ++i) {
-        RecruitCombs temp1 = rcs_with_single_tag[i];
-        if (temp1.opers.empty()) [[unlikely]] {
-            continue;               // this is not possible
-        }
-        result.emplace_back(temp1); // that is it
-
-        // but what if another tag is also selected
-        for (size_t j = i + 1; j < tag_size; ++j) {
-            RecruitCombs temp2 = temp1 * rcs_with_single_tag[j];
-            if (temp2.opers.empty()) [[unlikely]] {
-                continue;
-            }
-            result.emplace_back(temp2); // two tags only
-
-            // select a third one
-            for (size_t k = j + 1; k < tag_size; ++k) {
-                RecruitCombs temp3 = temp2 * rcs_with_single_tag[k];
-                if (temp3.opers.empty()) [[unlikely]] {
-                    continue;
-                }
-                result.emplace_back(temp3);
-            }
-        }
-    }
-
-    static constexpr std::string_view SeniorOper = "高级资深干员";
-
-    for (auto comb_iter = result.begin(); comb_iter != result.end();) {
-        if (ranges::find(comb_iter->tags, RecruitConfig::TagId(SeniorOper)) != comb_iter->tags.end()) {
-            ++comb_iter;
-            continue;
-        }
-        // no senior tag, remove 6-star operators
-        // assuming sorted by level
-        auto iter = ranges::find_if(comb_iter->opers, [](const Recruitment& op) { return op.level >= 6; });
-        if (iter == comb_iter->opers.end()) {
-            ++comb_iter;
-            continue;
-        }
-        comb_iter->opers.erase(iter, comb_iter->opers.end());
-        if (comb_iter->opers.empty()) {
-            comb_iter = result.erase(comb_iter);
-            continue;
-        }
-        comb_iter->update_attributes();
-        ++comb_iter;
-    }
-
-    return result;
-}
-} // namespace asst::recruit_calc
-
 asst::AutoRecruitTask& asst::AutoRecruitTask::set_select_level(std::vector<int> select_level) noexcept
 {
     m_select_level = std::move(select_level);
@@ -506,7 +407,7 @@ asst::AutoRecruitTask::calc_task_result_type asst::AutoRecruitTask::recruit_calc
             }
         }
 
-        std::vector<RecruitCombs> result_vec = recruit_calc::get_all_combs(tag_ids);
+        std::vector<RecruitCombs> result_vec = RecruitData.get_all_combs(tag_ids);
 
         // assuming timer would be set to 09:00:00
         for (RecruitCombs& rc : result_vec) {
@@ -177,7 +177,7 @@ bool asst::BattleProcessTask::do_action(const battle::copilot::Action& action, s
 
     // prevent our program from consuming too much CPU
     if (const auto now = std::chrono::steady_clock::now(); prev_frame_time > now - min_frame_interval) [[unlikely]] {
-        Log.debug("Sleeping for framerate limit");
+        LogDebugLazy("Sleeping for framerate limit");
         std::this_thread::sleep_for(min_frame_interval - (now - prev_frame_time));
     }
 
@@ -307,7 +307,7 @@ bool asst::BattleProcessTask::wait_condition(const Action& action)
     };
     auto do_strategy_and_update_image = [&]() {
         do_strategic_action(image);
-        image = ctrler()->get_image();
+        image = get_battle_frame();
     };
 
     if (action.cost_changes != 0) {
@@ -414,9 +414,14 @@ void asst::BattleProcessTask::sleep_and_do_strategy(unsigned millisecond)
     const auto start = std::chrono::steady_clock::now();
     const auto delay = millisecond * 1ms;
 
-    while (!need_exit() && std::chrono::steady_clock::now() - start < delay) {
-        do_strategic_action();
-        std::this_thread::yield();
+    while (!need_exit()) {
+        const auto remaining =
+            std::chrono::duration_cast<std::chrono::milliseconds>(delay - (std::chrono::steady_clock::now() - start));
+        if (remaining <= 0ms) {
+            break;
+        }
+        // 画面静止时歇一会再截，但不能歇过头
+        do_strategic_action(get_battle_frame(std::min<std::chrono::milliseconds>(remaining, 100ms)));
     }
 }
 
@@ -10,6 +10,7 @@
 #include "Config/TaskData.h"
 #include "Controller/Controller.h"
 #include "Status.h"
+#include "TaskMetrics.h"
 #include "Utils/Logger.hpp"
 #include "Vision/Miscellaneous/PipelineAnalyzer.h"
 
@@ -47,13 +48,13 @@ ProcessTask& ProcessTask::set_tasks(std::vector<std::string> tasks_name) noexcep
 
 ProcessTask& ProcessTask::set_times_limit(std::string name, int limit, TimesLimitType type)
 {
-    m_times_limit[std::move(name)] = TimesLimitData { limit, type };
+    m_times_limit[Task.name_id(name)] = TimesLimitData { limit, type };
     return *this;
 }
 
 ProcessTask& ProcessTask::set_post_delay(std::string name, int delay)
 {
-    m_post_delay[std::move(name)] = delay;
+    m_post_delay[Task.name_id(name)] = delay;
     return *this;
 }
 
@@ -137,30 +138,29 @@ bool ProcessTask::_run()
 #endif
 }
 
-ProcessTask::HitDetail ProcessTask::find_first(const TaskList& list) /* const, except m_reusable */
+ProcessTask::HitDetail ProcessTask::find_first(const std::vector<TaskPtr>& tasks) /* const, except m_reusable */
 {
-    if (list.empty()) [[unlikely]] {
+    if (tasks.empty()) [[unlikely]] {
         Log.warn(__FUNCTION__, "| empty task list");
         return { .task_ptr = nullptr };
     }
 
     // 如果第一个任务是JustReturn的，那就没必要再截图并计算了
-    TaskConstPtr task_ptr = Task.get(list.front());
-    if (task_ptr != nullptr && task_ptr->algorithm == AlgorithmType::JustReturn) {
-        return { .task_ptr = std::move(task_ptr) };
+    if (tasks.front()->algorithm == AlgorithmType::JustReturn) {
+        return { .task_ptr = tasks.front() };
     }
 
     cv::Mat image = m_reusable.empty() ? ctrler()->get_image() : m_reusable;
     m_reusable = cv::Mat();
     PipelineAnalyzer analyzer(image, Rect(), m_inst);
-    analyzer.set_tasks(list);
+    analyzer.set_tasks(tasks);
 
     auto res_opt = analyzer.analyze();
     if (!res_opt) {
         return { .task_ptr = nullptr };
     }
 
-    task_ptr = std::move(res_opt->task_ptr);
+    TaskConstPtr task_ptr = std::move(res_opt->task_ptr);
 
     if (task_ptr->algorithm == AlgorithmType::MatchTemplate) {
         auto& raw_result = std::get<0>(res_opt->result);
@@ -225,7 +225,7 @@ ProcessTask::NodeStatus ProcessTask::run_task(const HitDetail& hits)
 {
     const auto& task = hits.task_ptr;
     const auto& task_name = task->name;
-    int& exec_times = m_exec_times[task_name];
+    int& exec_times = m_exec_times[task->name_id];
     auto [max_times, limit_type] = calc_time_limit(task);
     json::value info = basic_info();
 
@@ -260,7 +260,12 @@ ProcessTask::NodeStatus ProcessTask::run_task(const HitDetail& hits)
     }
 
     // 前置固定延时
-    if (!sleep(task->pre_delay)) {
+    MetricsTimer pre_delay_timer;
+    bool pre_delay_ret = sleep(task->pre_delay);
+    if (auto metrics_ptr = metrics()) {
+        metrics_ptr->add_pre_delay(task_name, pre_delay_timer.elapsed());
+    }
+    if (!pre_delay_ret) {
         return NodeStatus::Interrupted;
     }
 
@@ -275,14 +280,19 @@ ProcessTask::NodeStatus ProcessTask::run_task(const HitDetail& hits)
     // 例如，进入吃理智药的界面了，相当于上一次点蓝色开始行动没生效
     // 所以要给蓝色开始行动的次数减一
     for (const std::string& other_task : task->reduce_other_times) {
-        if (int& v = m_exec_times[other_task]; v > 0) {
+        if (int& v = m_exec_times[Task.name_id(other_task)]; v > 0) {
             --v;
             Log.trace("task `", task_name, "` reduce `", other_task, "` exec times to", v);
         }
     }
 
     // 后置固定延时
-    if (!sleep(calc_post_delay(task))) {
+    MetricsTimer post_delay_timer;
+    bool post_delay_ret = sleep(calc_post_delay(task));
+    if (auto metrics_ptr = metrics()) {
+        metrics_ptr->add_post_delay(task_name, post_delay_timer.elapsed());
+    }
+    if (!post_delay_ret) {
         return NodeStatus::Interrupted;
     }
 
@@ -335,6 +345,8 @@ std::pair<ProcessTask::NodeStatus, TaskConstPtr> ProcessTask::find_and_run_task(
 
     m_pre_task_name = std::move(m_last_task_name);
 
+    // 重试时列表不会变，只取一次
+    const std::vector<TaskPtr> tasks = PipelineAnalyzer::resolve_tasks(list);
     HitDetail hits;
     for (int cur_retry = 0; cur_retry <= m_retry_times; ++cur_retry) {
         json::value info = basic_info();
@@ -345,10 +357,16 @@ std::pair<ProcessTask::NodeStatus, TaskConstPtr> ProcessTask::find_and_run_task(
         };
         Log.info(info.to_string());
 
-        if (cur_retry != 0 && !sleep(m_task_delay)) {
-            return { NodeStatus::Interrupted, nullptr };
+        if (cur_retry != 0) {
+            // 重试记在待识别列表的第一个任务上
+            if (auto metrics_ptr = metrics(); metrics_ptr && !list.empty()) {
+                metrics_ptr->add_retry(list.front());
+            }
+            if (!sleep(m_task_delay)) {
+                return { NodeStatus::Interrupted, nullptr };
+            }
         }
-        if (hits = find_first(list); hits.task_ptr != nullptr) {
+        if (hits = find_first(tasks); hits.task_ptr != nullptr) {
             m_last_task_name = hits.task_ptr->name;
             break;
         }
@@ -367,34 +385,28 @@ std::pair<ProcessTask::NodeStatus, TaskConstPtr> ProcessTask::find_and_run_task(
 
 ProcessTask::TimesLimitData ProcessTask::calc_time_limit(TaskConstPtr task) const
 {
-    std::string task_name = task->name;
     // eg. "C@B@A" 的 times_limit 取 "C@B@A", "B@A", "A" 中有设置 m_times_limit 的最靠前者，否则取 task 的值
-    while (true) {
-        if (auto iter = m_times_limit.find(task_name); iter != m_times_limit.cend()) {
-            return { .times = iter->second.times, .type = iter->second.type };
-        }
-        size_t at_pos = task_name.find('@');
-        if (at_pos == std::string::npos) {
-            return { .times = task->max_times, .type = TimesLimitType::Pre };
+    if (!m_times_limit.empty()) {
+        for (TaskNameId id = task->name_id; id != InvalidTaskNameId; id = Task.suffix_name_id(id)) {
+            if (auto iter = m_times_limit.find(id); iter != m_times_limit.cend()) {
+                return { .times = iter->second.times, .type = iter->second.type };
+            }
         }
-        task_name = task_name.substr(at_pos + 1);
     }
+    return { .times = task->max_times, .type = TimesLimitType::Pre };
 }
 
 int ProcessTask::calc_post_delay(TaskConstPtr task) const
 {
-    std::string task_name = task->name;
     // eg. "C@B@A" 的 post_delay 取 "C@B@A", "B@A", "A" 中有设置 m_post_delay 的最靠前者，否则取 task 的值
-    while (true) {
-        if (auto iter = m_post_delay.find(task_name); iter != m_post_delay.cend()) {
-            return iter->second;
-        }
-        size_t at_pos = task_name.find('@');
-        if (at_pos == std::string::npos) {
-            return task->post_delay;
+    if (!m_post_delay.empty()) {
+        for (TaskNameId id = task->name_id; id != InvalidTaskNameId; id = Task.suffix_name_id(id)) {
+            if (auto iter = m_post_delay.find(id); iter != m_post_delay.cend()) {
+                return iter->second;
+            }
         }
-        task_name = task_name.substr(at_pos + 1);
     }
+    return task->post_delay;
 }
 
 json::value ProcessTask::basic_info() const
@@ -59,7 +59,7 @@ protected:
     virtual bool _run() override;
     virtual json::value basic_info() const override;
 
-    HitDetail find_first(const TaskList& list);
+    HitDetail find_first(const std::vector<TaskPtr>& tasks);
     NodeStatus run_action(const HitDetail& hits) const;
     NodeStatus run_task(const HitDetail& hits);
     std::pair<NodeStatus, TaskConstPtr> find_and_run_task(const TaskList& list);
@@ -80,9 +80,10 @@ protected:
     TaskList m_begin_task_list;
     std::string m_pre_task_name;
     std::string m_last_task_name;
-    std::unordered_map<std::string, int> m_post_delay;
-    std::unordered_map<std::string, TimesLimitData> m_times_limit;
-    std::unordered_map<std::string, int> m_exec_times;
+    // 以下均以任务名的编号为 key，见 TaskData::name_id
+    std::unordered_map<TaskNameId, int> m_post_delay;
+    std::unordered_map<TaskNameId, TimesLimitData> m_times_limit;
+    std::unordered_map<TaskNameId, int> m_exec_times;
     static constexpr int TaskDelayUnsetted = -1;
     int m_task_delay = TaskDelayUnsetted;
     cv::Mat m_reusable;
@@ -160,11 +160,12 @@ bool asst::RoguelikeBattleTaskPlugin::calc_stage_info()
             calced = true;
             m_stage_name = text;
             m_map_data = TilePack::find_level(stage_key).value_or(Map::Level {});
-            auto calc_result = TilePack::calc(m_map_data);
+            auto calc_result = TilePack::calc(stage_key);
             m_normal_tile_info = std::move(calc_result.normal_tile_info);
             m_side_tile_info = std::move(calc_result.side_tile_info);
             m_retreat_button_pos = calc_result.retreat_button;
             m_skill_button_pos = calc_result.skill_button;
+            m_coverage_map.build(m_side_tile_info);
             break;
         }
 
@@ -351,7 +352,7 @@ bool asst::RoguelikeBattleTaskPlugin::do_best_deploy()
             }
         }
     }
-    Log.debug("No operator needs to be retreated.");
+    LogDebugLazy("No operator needs to be retreated.");
     // 构造当前地图的部署指令列表
     std::vector<DeployPlanInfo> deploy_plan_list;
     // 获取当前肉鸽的分组信息[干员组1名称,干员组2名称,...]
@@ -361,7 +362,7 @@ bool asst::RoguelikeBattleTaskPlugin::do_best_deploy()
     for (const auto& oper : m_cur_deployment_opers) {
         // 干员冷却中
         if (oper.cooling) {
-            Log.debug("operator", oper.name, "is cooling now.");
+            LogDebugLazy("operator", oper.name, "is cooling now.");
             continue;
         }
 
@@ -374,11 +375,11 @@ bool asst::RoguelikeBattleTaskPlugin::do_best_deploy()
         for (const auto& group_id : group_ids) {
             // 当前干员组名,string类型
             std::string group_name = groups[group_id];
-            Log.debug(m_stage_name, "group_name", group_name);
+            LogDebugLazy(m_stage_name, "group_name", group_name);
             if (m_deploy_plan.contains(group_name)) {
                 for (const auto& info : m_deploy_plan[group_name]) {
                     if (m_kills < info.kill_lower_bound || m_kills > info.kill_upper_bound) {
-                        Log.debug("    deploy info", oper.name, "in group", group_name, "is waiting.");
+                        LogDebugLazy("    deploy info", oper.name, "in group", group_name, "is waiting.");
                         is_success = true; // 如果发现了待命干员，此函数最终返回true
                         continue;
                     }
@@ -394,7 +395,7 @@ bool asst::RoguelikeBattleTaskPlugin::do_best_deploy()
                     deploy_plan.placed = info.location;
                     deploy_plan.direction = info.direction;
                     deploy_plan_list.emplace_back(deploy_plan);
-                    Log.debug(
+                    LogDebugLazy(
                         "    deploy info",
                         deploy_plan.oper_name,
                         "is No. ",
@@ -447,19 +448,10 @@ bool asst::RoguelikeBattleTaskPlugin::do_once()
 {
     check_drone_tiles();
 
-    // TODO: move this to controller
-    thread_local auto prev_frame_time = std::chrono::steady_clock::time_point {};
-    static const auto min_frame_interval =
+    // 画面有变化就马上处理，没变化的区域不会重新识别；整个画面都静止时才按配置的间隔截图
+    static const auto idle_interval =
         std::chrono::milliseconds(Config.get_options().roguelike_fight_screencap_interval);
-
-    // prevent our program from consuming too much CPU
-    if (const auto now = std::chrono::steady_clock::now(); prev_frame_time > now - min_frame_interval) [[unlikely]] {
-        Log.debug("Sleeping for framerate limit");
-        std::this_thread::sleep_for(min_frame_interval - (now - prev_frame_time));
-    }
-
-    cv::Mat image = ctrler()->get_image();
-    prev_frame_time = std::chrono::steady_clock::now();
+    cv::Mat image = get_battle_frame(idle_interval);
 
     if (!m_first_deploy) {
         use_all_ready_skill(image);
@@ -844,6 +836,7 @@ void asst::RoguelikeBattleTaskPlugin::clear()
     m_deployed_time.clear();
 
     m_oper_elite.clear();
+    m_coverage_map.clear();
 }
 
 std::vector<asst::Point> asst::RoguelikeBattleTaskPlugin::available_locations(const DeploymentOper& oper) const
@@ -919,19 +912,7 @@ asst::battle::AttackRange asst::RoguelikeBattleTaskPlugin::get_attack_range(
         }
     }
 
-    for (auto cur_direction :
-         { DeployDirection::Right, DeployDirection::Up, DeployDirection::Left, DeployDirection::Down }) {
-        if (cur_direction == direction) {
-            break;
-        }
-
-        // rotate relative attack range counterclockwise
-        for (Point& point : right_attack_range) {
-            point = { point.y, -point.x };
-        }
-    }
-
-    return right_attack_range;
+    return RoguelikeCoverageMap::rotate(std::move(right_attack_range), direction);
 }
 
 std::optional<asst::RoguelikeBattleTaskPlugin::DeployInfo>
@@ -971,10 +952,23 @@ std::optional<asst::RoguelikeBattleTaskPlugin::DeployInfo>
     const auto& near_loc = available_loc.front();
     int min_dist = std::abs(near_loc.x - home.location.x) + std::abs(near_loc.y - home.location.y);
 
-    // 取距离最近的N个点，计算分数。然后使用得分最高的点
-    constexpr int CalcPointCount = 4;
-    for (const auto& loc : available_loc | views::take(CalcPointCount)) {
-        const auto& [cur_direction, cur_socre] = calc_best_direction_and_score(loc, oper, home.direction);
+    // 治疗干员的分数要看周围有多少人，每次部署只算一次
+    std::vector<Point> occupied_locs;
+    if (oper.role == battle::Role::Medic) {
+        for (const auto& [loc, name] : m_used_tiles) {
+            if (BattleData.get_role(name) != battle::Role::Drone) {
+                occupied_locs.emplace_back(loc);
+            }
+        }
+    }
+    const RoguelikeCoverageMap::TileMask occupied = m_coverage_map.make_mask(occupied_locs);
+
+    // 所有可用的点都算一遍分数，离得远的会扣分，然后使用得分最高的点
+    // 医疗干员离得远不扣分，还是只在最近的几个点里挑，免得跑去治别的家门
+    constexpr size_t MedicCalcPointCount = 4;
+    const size_t calc_count = oper.role == battle::Role::Medic ? MedicCalcPointCount : available_loc.size();
+    for (const auto& loc : available_loc | views::take(calc_count)) {
+        const auto& [cur_direction, cur_socre] = calc_best_direction_and_score(loc, oper, home.direction, occupied);
         // 离得远的要扣分
         constexpr int DistWeights = -1050;
         int extra_dist = std::abs(loc.x - home.location.x) + std::abs(loc.y - home.location.y) - min_dist;
@@ -1003,10 +997,9 @@ std::optional<asst::RoguelikeBattleTaskPlugin::DeployInfo>
 asst::RoguelikeBattleTaskPlugin::DirectionAndScore asst::RoguelikeBattleTaskPlugin::calc_best_direction_and_score(
     Point loc,
     const battle::DeploymentOper& oper,
-    DeployDirection recommended_direction) const
+    DeployDirection recommended_direction,
+    const RoguelikeCoverageMap::TileMask& occupied) const
 {
-    LogTraceFunction;
-
     size_t home_index = m_cur_home_index;
     if (home_index >= m_homes.size()) {
         Log.warn("home index is out of range", m_cur_home_index, m_homes.size());
@@ -1059,48 +1052,21 @@ asst::RoguelikeBattleTaskPlugin::DirectionAndScore asst::RoguelikeBattleTaskPlug
     int max_score = 0;
     DeployDirection best_direction = DeployDirection::None;
 
+    const auto loc_index = m_coverage_map.index(loc);
+    const battle::AttackRange right_range = get_attack_range(oper);
     for (auto direction :
          { DeployDirection::Right, DeployDirection::Up, DeployDirection::Left, DeployDirection::Down }) {
         int score = 0;
-        // 按朝右算，后面根据方向做转换
-        for (const Point& relative_pos : get_attack_range(oper, direction)) {
-            Point absolute_pos = loc + relative_pos;
-
-            using TileKey = TilePack::TileKey;
-            // 战斗干员朝向的权重
-            static const std::unordered_map<TileKey, int> TileKeyFightWeights = {
-                { TileKey::Invalid, 0 },    { TileKey::Forbidden, 0 },  { TileKey::Wall, 500 },
-                { TileKey::Road, 1000 },    { TileKey::Home, 500 },     { TileKey::EnemyHome, 1000 },
-                { TileKey::Airport, 1000 }, { TileKey::Floor, 1000 },   { TileKey::Hole, 0 },
-                { TileKey::Telin, 700 },    { TileKey::Telout, 800 },   { TileKey::Grass, 500 },
-                { TileKey::DeepSea, 1000 }, { TileKey::Volcano, 1000 }, { TileKey::Healing, 1000 },
-                { TileKey::Fence, 800 },
-            };
-            // 治疗干员朝向的权重
-            static const std::unordered_map<TileKey, int> TileKeyMedicWeights = {
-                { TileKey::Invalid, 0 },  { TileKey::Forbidden, 0 },  { TileKey::Wall, 1000 },
-                { TileKey::Road, 1000 },  { TileKey::Home, 0 },       { TileKey::EnemyHome, 0 },
-                { TileKey::Airport, 0 },  { TileKey::Floor, 0 },      { TileKey::Hole, 0 },
-                { TileKey::Telin, 0 },    { TileKey::Telout, 0 },     { TileKey::Grass, 500 },
-                { TileKey::DeepSea, 0 },  { TileKey::Volcano, 1000 }, { TileKey::Healing, 1000 },
-                { TileKey::Fence, 1000 },
-            };
-
+        if (loc_index) {
+            const auto& coverage = m_coverage_map.coverages(right_range, direction).at(*loc_index);
             switch (oper.role) {
             case battle::Role::Medic:
-                if (auto iter = m_used_tiles.find(absolute_pos);
-                    iter != m_used_tiles.cend() &&
-                    BattleData.get_role(iter->second) != battle::Role::Drone) { // 根据哪个方向上人多决定朝向哪
-                    score += 10000;
-                }
-                if (auto iter = m_side_tile_info.find(absolute_pos); iter != m_side_tile_info.end()) {
-                    score += TileKeyMedicWeights.at(iter->second.key);
-                }
+                // 根据哪个方向上人多决定朝向哪
+                score += 10000 * RoguelikeCoverageMap::count(coverage, occupied);
+                score += m_coverage_map.medic_score(coverage);
                 break;
             default:
-                if (auto iter = m_side_tile_info.find(absolute_pos); iter != m_side_tile_info.end()) {
-                    score += TileKeyFightWeights.at(iter->second.key);
-                }
+                score += m_coverage_map.fight_score(coverage);
                 break;
             }
         }
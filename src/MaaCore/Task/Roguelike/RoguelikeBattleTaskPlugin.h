@@ -7,6 +7,7 @@
 #include "Common/AsstBattleDef.h"
 #include "Common/AsstTypes.h"
 #include "Config/Miscellaneous/TilePack.h"
+#include "RoguelikeCoverageMap.h"
 #include "Task/BattleHelper.h"
 
 namespace asst
@@ -84,7 +85,8 @@ protected:
     DirectionAndScore calc_best_direction_and_score(
         Point loc,
         const battle::DeploymentOper& oper,
-        battle::DeployDirection recommended_direction) const;
+        battle::DeployDirection recommended_direction,
+        const RoguelikeCoverageMap::TileMask& occupied) const;
 
     void postproc_of_deployment_conditions(
         const battle::DeploymentOper& oper,
@@ -169,5 +171,8 @@ protected:
     std::unordered_map<std::string, int64_t> m_oper_elite;
     // 缓存干员精英情况
     void cache_oper_elite_status();
+
+    // 关卡地图的格子位图，calc_stage_info 时建好
+    RoguelikeCoverageMap m_coverage_map;
 };
 } // namespace asst
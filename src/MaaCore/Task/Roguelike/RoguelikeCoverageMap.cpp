@@ -0,0 +1,177 @@
+#include "RoguelikeCoverageMap.h"
+
+#include <algorithm>
+#include <bit>
+
+#include "Utils/Ranges.hpp"
+
+namespace
+{
+using TileKey = asst::TilePack::TileKey;
+
+// 战斗干员朝向的权重
+const std::unordered_map<TileKey, int> TileKeyFightWeights = {
+    { TileKey::Invalid, 0 },    { TileKey::Forbidden, 0 },  { TileKey::Wall, 500 },
+    { TileKey::Road, 1000 },    { TileKey::Home, 500 },     { TileKey::EnemyHome, 1000 },
+    { TileKey::Airport, 1000 }, { TileKey::Floor, 1000 },   { TileKey::Hole, 0 },
+    { TileKey::Telin, 700 },    { TileKey::Telout, 800 },   { TileKey::Grass, 500 },
+    { TileKey::DeepSea, 1000 }, { TileKey::Volcano, 1000 }, { TileKey::Healing, 1000 },
+    { TileKey::Fence, 800 },
+};
+// 治疗干员朝向的权重
+const std::unordered_map<TileKey, int> TileKeyMedicWeights = {
+    { TileKey::Invalid, 0 },  { TileKey::Forbidden, 0 },  { TileKey::Wall, 1000 },
+    { TileKey::Road, 1000 },  { TileKey::Home, 0 },       { TileKey::EnemyHome, 0 },
+    { TileKey::Airport, 0 },  { TileKey::Floor, 0 },      { TileKey::Hole, 0 },
+    { TileKey::Telin, 0 },    { TileKey::Telout, 0 },     { TileKey::Grass, 500 },
+    { TileKey::DeepSea, 0 },  { TileKey::Volcano, 1000 }, { TileKey::Healing, 1000 },
+    { TileKey::Fence, 1000 },
+};
+
+constexpr size_t WordBits = 64;
+
+void set_bit(asst::RoguelikeCoverageMap::TileMask& mask, size_t index)
+{
+    mask[index / WordBits] |= uint64_t(1) << (index % WordBits);
+}
+}
+
+void asst::RoguelikeCoverageMap::build(const std::unordered_map<Point, TilePack::TileInfo>& tile_info)
+{
+    clear();
+    for (const Point& loc : tile_info | views::keys) {
+        if (loc.x < 0 || loc.y < 0) {
+            continue;
+        }
+        m_width = std::max(m_width, loc.x + 1);
+        m_height = std::max(m_height, loc.y + 1);
+    }
+    m_tile_count = static_cast<size_t>(m_width) * m_height;
+    if (m_tile_count == 0) {
+        return;
+    }
+
+    const size_t words = (m_tile_count + WordBits - 1) / WordBits;
+    auto add_weight = [&](WeightMasks& weight_masks, int weight, size_t index) {
+        if (weight == 0) {
+            return;
+        }
+        auto iter = ranges::find(weight_masks, weight, &WeightMasks::value_type::first);
+        if (iter == weight_masks.end()) {
+            iter = weight_masks.insert(weight_masks.end(), { weight, TileMask(words, 0) });
+        }
+        set_bit(iter->second, index);
+    };
+
+    for (const auto& [loc, tile] : tile_info) {
+        auto index_opt = index(loc);
+        if (!index_opt) {
+            continue;
+        }
+        add_weight(m_fight_weights, TileKeyFightWeights.at(tile.key), *index_opt);
+        add_weight(m_medic_weights, TileKeyMedicWeights.at(tile.key), *index_opt);
+    }
+}
+
+void asst::RoguelikeCoverageMap::clear()
+{
+    m_width = 0;
+    m_height = 0;
+    m_tile_count = 0;
+    m_fight_weights.clear();
+    m_medic_weights.clear();
+    m_coverages.clear();
+}
+
+std::optional<size_t> asst::RoguelikeCoverageMap::index(const Point& loc) const
+{
+    if (loc.x < 0 || loc.y < 0 || loc.x >= m_width || loc.y >= m_height) {
+        return std::nullopt;
+    }
+    return static_cast<size_t>(loc.y) * m_width + loc.x;
+}
+
+asst::RoguelikeCoverageMap::TileMask asst::RoguelikeCoverageMap::make_mask(const std::vector<Point>& locs) const
+{
+    TileMask mask((m_tile_count + WordBits - 1) / WordBits, 0);
+    for (const Point& loc : locs) {
+        if (auto index_opt = index(loc)) {
+            set_bit(mask, *index_opt);
+        }
+    }
+    return mask;
+}
+
+const std::vector<asst::RoguelikeCoverageMap::TileMask>& asst::RoguelikeCoverageMap::coverages(
+    const battle::AttackRange& right_range,
+    battle::DeployDirection direction) const
+{
+    auto key = std::make_pair(right_range, direction);
+    if (auto iter = m_coverages.find(key); iter != m_coverages.end()) {
+        return iter->second;
+    }
+
+    // 一次把所有格子都算好，之后这个干员再部署、或者同样攻击范围的干员部署都不用再算
+    const battle::AttackRange range = rotate(right_range, direction);
+    std::vector<TileMask> result;
+    result.reserve(m_tile_count);
+    for (int y = 0; y < m_height; ++y) {
+        for (int x = 0; x < m_width; ++x) {
+            const Point loc(x, y);
+            std::vector<Point> covered;
+            covered.reserve(range.size());
+            ranges::transform(range, std::back_inserter(covered), [&](const Point& relative_pos) {
+                return loc + relative_pos;
+            });
+            result.emplace_back(make_mask(covered));
+        }
+    }
+    return m_coverages.emplace(std::move(key), std::move(result)).first->second;
+}
+
+int asst::RoguelikeCoverageMap::fight_score(const TileMask& coverage) const
+{
+    return weighted_count(m_fight_weights, coverage);
+}
+
+int asst::RoguelikeCoverageMap::medic_score(const TileMask& coverage) const
+{
+    return weighted_count(m_medic_weights, coverage);
+}
+
+int asst::RoguelikeCoverageMap::count(const TileMask& lhs, const TileMask& rhs)
+{
+    int result = 0;
+    const size_t words = std::min(lhs.size(), rhs.size());
+    for (size_t i = 0; i < words; ++i) {
+        result += std::popcount(lhs[i] & rhs[i]);
+    }
+    return result;
+}
+
+asst::battle::AttackRange
+    asst::RoguelikeCoverageMap::rotate(battle::AttackRange right_range, battle::DeployDirection direction)
+{
+    using battle::DeployDirection;
+    for (auto cur_direction :
+         { DeployDirection::Right, DeployDirection::Up, DeployDirection::Left, DeployDirection::Down }) {
+        if (cur_direction == direction) {
+            break;
+        }
+
+        // rotate relative attack range counterclockwise
+        for (Point& point : right_range) {
+            point = { point.y, -point.x };
+        }
+    }
+    return right_range;
+}
+
+int asst::RoguelikeCoverageMap::weighted_count(const WeightMasks& weight_masks, const TileMask& coverage)
+{
+    int score = 0;
+    for (const auto& [weight, mask] : weight_masks) {
+        score += weight * count(mask, coverage);
+    }
+    return score;
+}
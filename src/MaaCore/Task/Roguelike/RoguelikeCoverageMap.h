@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Common/AsstBattleDef.h"
+#include "Common/AsstTypes.h"
+#include "Config/Miscellaneous/TilePack.h"
+
+namespace asst
+{
+// 关卡地图的格子位图，部署时给每个候选位置和朝向的攻击范围算分用
+// 进关卡时按地块类型建好各个权重的格子位图，攻击范围在每个格子上覆盖到的格子按 (范围, 朝向) 缓存，
+// 算分只要把位图按位与一下再数 1 的个数
+class RoguelikeCoverageMap
+{
+public:
+    using TileMask = std::vector<uint64_t>;
+
+    void build(const std::unordered_map<Point, TilePack::TileInfo>& tile_info);
+    void clear();
+    bool empty() const noexcept { return m_tile_count == 0; }
+
+    // 格子在位图中的下标，不在地图上的返回空
+    std::optional<size_t> index(const Point& loc) const;
+    TileMask make_mask(const std::vector<Point>& locs) const;
+
+    // 朝右的攻击范围转到 direction 之后，放在地图上每个格子时覆盖到的格子，按 index 的下标排列
+    const std::vector<TileMask>&
+        coverages(const battle::AttackRange& right_range, battle::DeployDirection direction) const;
+
+    // 攻击范围覆盖到的地块按类型加权的分数，战斗干员和治疗干员关心的地块不一样
+    int fight_score(const TileMask& coverage) const;
+    int medic_score(const TileMask& coverage) const;
+
+    // 两个位图都有的格子数
+    static int count(const TileMask& lhs, const TileMask& rhs);
+    // 按 Right -> Up -> Left -> Down 的顺序逆时针旋转
+    static battle::AttackRange rotate(battle::AttackRange right_range, battle::DeployDirection direction);
+
+private:
+    using WeightMasks = std::vector<std::pair<int, TileMask>>; // 权重 -> 这个权重的格子
+
+    static int weighted_count(const WeightMasks& weight_masks, const TileMask& coverage);
+
+    int m_width = 0;
+    int m_height = 0;
+    size_t m_tile_count = 0;
+    WeightMasks m_fight_weights;
+    WeightMasks m_medic_weights;
+    mutable std::map<std::pair<battle::AttackRange, battle::DeployDirection>, std::vector<TileMask>> m_coverages;
+};
+} // namespace asst
@@ -104,7 +104,7 @@ bool asst::SSSBattleProcessTask::do_strategic_action(const cv::Mat& reusable)
 
     // prevent our program from consuming too much CPU
     if (const auto now = std::chrono::steady_clock::now(); prev_frame_time > now - min_frame_interval) [[unlikely]] {
-        Log.debug("Sleeping for framerate limit");
+        LogDebugLazy("Sleeping for framerate limit");
         std::this_thread::sleep_for(min_frame_interval - (now - prev_frame_time));
     }
 
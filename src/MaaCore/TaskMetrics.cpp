@@ -0,0 +1,115 @@
+#include "TaskMetrics.h"
+
+#include <bit>
+
+void asst::TaskMetrics::Histogram::add(clock::duration elapsed) noexcept
+{
+    using namespace std::chrono;
+    const int64_t us = std::max<int64_t>(duration_cast<microseconds>(elapsed).count(), 0);
+    // 向上取整到 ms，再按 2 的幂分桶：[0, 1] -> 0, (1, 2] -> 1, (2, 4] -> 2 ...
+    const auto ms = static_cast<uint64_t>((us + 999) / 1000);
+    const size_t index = ms <= 1 ? 0 : static_cast<size_t>(std::bit_width(ms - 1));
+    ++m_buckets[std::min(index, BucketCount - 1)];
+    ++m_count;
+    m_total_us += us;
+    m_max_us = std::max(m_max_us, us);
+}
+
+json::value asst::TaskMetrics::Histogram::to_json() const
+{
+    json::array buckets;
+    for (uint64_t bucket : m_buckets) {
+        buckets.emplace_back(static_cast<unsigned long long>(bucket));
+    }
+    return json::object {
+        { "count", static_cast<unsigned long long>(m_count) },
+        { "total_ms", m_total_us / 1000.0 },
+        { "avg_ms", m_count ? m_total_us / 1000.0 / static_cast<double>(m_count) : 0.0 },
+        { "max_ms", m_max_us / 1000.0 },
+        { "buckets", std::move(buckets) },
+    };
+}
+
+void asst::TaskMetrics::add_screencap(clock::duration elapsed)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_screencap.add(elapsed);
+}
+
+void asst::TaskMetrics::add_recognition(
+    const std::string& task_name,
+    AlgorithmType algorithm,
+    clock::duration elapsed,
+    bool hit)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_algorithms[algorithm].add(elapsed);
+
+    auto& stats = m_tasks[task_name];
+    stats.algorithm = algorithm;
+    stats.recognition.add(elapsed);
+    ++(hit ? stats.hit : stats.miss);
+}
+
+void asst::TaskMetrics::add_retry(const std::string& task_name)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    ++m_tasks[task_name].retry;
+}
+
+void asst::TaskMetrics::add_pre_delay(const std::string& task_name, clock::duration elapsed)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_tasks[task_name].pre_delay.add(elapsed);
+}
+
+void asst::TaskMetrics::add_post_delay(const std::string& task_name, clock::duration elapsed)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_tasks[task_name].post_delay.add(elapsed);
+}
+
+json::value asst::TaskMetrics::to_json() const
+{
+    json::array bucket_bounds;
+    for (size_t i = 0; i + 1 < Histogram::BucketCount; ++i) {
+        bucket_bounds.emplace_back(1LL << i);
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    json::object algorithms;
+    for (const auto& [algorithm, histogram] : m_algorithms) {
+        algorithms.emplace(enum_to_string(algorithm), histogram.to_json());
+    }
+
+    json::object tasks;
+    for (const auto& [name, stats] : m_tasks) {
+        tasks.emplace(
+            name,
+            json::object {
+                { "algorithm", enum_to_string(stats.algorithm) },
+                { "hit", static_cast<unsigned long long>(stats.hit) },
+                { "miss", static_cast<unsigned long long>(stats.miss) },
+                { "retry", static_cast<unsigned long long>(stats.retry) },
+                { "recognition", stats.recognition.to_json() },
+                { "pre_delay", stats.pre_delay.to_json() },
+                { "post_delay", stats.post_delay.to_json() },
+            });
+    }
+
+    return json::object {
+        { "bucket_upper_bounds_ms", std::move(bucket_bounds) },
+        { "screencap", m_screencap.to_json() },
+        { "algorithms", std::move(algorithms) },
+        { "tasks", std::move(tasks) },
+    };
+}
+
+void asst::TaskMetrics::clear()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_screencap = Histogram();
+    m_algorithms.clear();
+    m_tasks.clear();
+}
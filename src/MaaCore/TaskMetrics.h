@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <meojson/json.hpp>
+
+#include "Common/AsstTypes.h"
+
+namespace asst
+{
+// 实例级的识别耗时统计，按任务名汇总命中率、重试次数以及各阶段的耗时直方图
+// 通过 AsstGetMetrics 以 json 的形式导出
+class TaskMetrics
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    // 桶的上界依次为 1, 2, 4, ..., 8192 ms，最后一个桶放所有更长的
+    class Histogram
+    {
+    public:
+        static constexpr size_t BucketCount = 15;
+
+        void add(clock::duration elapsed) noexcept;
+        json::value to_json() const;
+
+    private:
+        std::array<uint64_t, BucketCount> m_buckets {};
+        uint64_t m_count = 0;
+        int64_t m_total_us = 0;
+        int64_t m_max_us = 0;
+    };
+
+public:
+    TaskMetrics() = default;
+    TaskMetrics(const TaskMetrics&) = delete;
+    TaskMetrics(TaskMetrics&&) noexcept = delete;
+    ~TaskMetrics() = default;
+
+    void add_screencap(clock::duration elapsed);
+    void add_recognition(const std::string& task_name, AlgorithmType algorithm, clock::duration elapsed, bool hit);
+    void add_retry(const std::string& task_name);
+    void add_pre_delay(const std::string& task_name, clock::duration elapsed);
+    void add_post_delay(const std::string& task_name, clock::duration elapsed);
+
+    json::value to_json() const;
+    void clear();
+
+    TaskMetrics& operator=(const TaskMetrics&) = delete;
+    TaskMetrics& operator=(TaskMetrics&&) noexcept = delete;
+
+private:
+    struct TaskStats
+    {
+        AlgorithmType algorithm = AlgorithmType::Invalid;
+        uint64_t hit = 0;
+        uint64_t miss = 0;
+        uint64_t retry = 0;
+        Histogram recognition;
+        Histogram pre_delay;
+        Histogram post_delay;
+    };
+
+    mutable std::mutex m_mutex;
+    Histogram m_screencap;
+    std::unordered_map<AlgorithmType, Histogram> m_algorithms;
+    std::unordered_map<std::string, TaskStats> m_tasks;
+};
+
+// 简单的计时器，从构造时开始计时
+class MetricsTimer
+{
+public:
+    MetricsTimer() noexcept :
+        m_start(TaskMetrics::clock::now())
+    {
+    }
+
+    TaskMetrics::clock::duration elapsed() const noexcept { return TaskMetrics::clock::now() - m_start; }
+
+private:
+    TaskMetrics::clock::time_point m_start;
+};
+}
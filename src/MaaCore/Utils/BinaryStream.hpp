@@ -0,0 +1,220 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "Common/AsstTypes.h"
+
+namespace asst::utils
+{
+// 简单的二进制序列化，按本机字节序读写，只用于本机生成、本机读取的缓存文件
+class BinaryWriter
+{
+public:
+    template <typename T>
+    requires(std::is_arithmetic_v<T> || std::is_enum_v<T>)
+    void write(T value)
+    {
+        m_buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void write(std::string_view str)
+    {
+        write(static_cast<uint32_t>(str.size()));
+        m_buffer.append(str);
+    }
+
+    void write(const std::string& str) { write(std::string_view(str)); }
+
+    void write(const asst::Rect& rect)
+    {
+        write(rect.x);
+        write(rect.y);
+        write(rect.width);
+        write(rect.height);
+    }
+
+    template <typename T, typename U>
+    void write(const std::pair<T, U>& pair)
+    {
+        write(pair.first);
+        write(pair.second);
+    }
+
+    template <typename T, size_t N>
+    void write(const std::array<T, N>& arr)
+    {
+        for (const auto& elem : arr) {
+            write(elem);
+        }
+    }
+
+    template <typename... Ts>
+    void write(const std::variant<Ts...>& var)
+    {
+        write(static_cast<uint8_t>(var.index()));
+        std::visit([&](const auto& elem) { write(elem); }, var);
+    }
+
+    template <typename T>
+    void write(const std::vector<T>& vec)
+    {
+        write(static_cast<uint32_t>(vec.size()));
+        for (const auto& elem : vec) {
+            write(elem);
+        }
+    }
+
+    void write_bytes(const void* data, size_t size) { m_buffer.append(static_cast<const char*>(data), size); }
+
+    // 用 0 填充到 alignment 的整数倍
+    void align(size_t alignment) { m_buffer.resize((m_buffer.size() + alignment - 1) / alignment * alignment, '\0'); }
+
+    // 回填之前写过的位置，比如先占位、之后才知道的偏移量
+    template <typename T>
+    requires(std::is_arithmetic_v<T>)
+    void overwrite(size_t pos, T value)
+    {
+        std::memcpy(m_buffer.data() + pos, &value, sizeof(T));
+    }
+
+    size_t size() const noexcept { return m_buffer.size(); }
+
+    const std::string& buffer() const noexcept { return m_buffer; }
+
+private:
+    std::string m_buffer;
+};
+
+// 任何越界都会让 ok() 变为 false，之后的读取全部返回默认值
+class BinaryReader
+{
+public:
+    explicit BinaryReader(std::string_view data) :
+        m_data(data)
+    {
+    }
+
+    bool ok() const noexcept { return m_ok; }
+
+    bool eof() const noexcept { return m_pos == m_data.size(); }
+
+    size_t position() const noexcept { return m_pos; }
+
+    void seek(size_t pos) noexcept
+    {
+        if (pos > m_data.size()) {
+            m_ok = false;
+            return;
+        }
+        m_pos = pos;
+    }
+
+    template <typename T>
+    requires(std::is_arithmetic_v<T> || std::is_enum_v<T>)
+    void read(T& value)
+    {
+        if (!take(sizeof(T))) {
+            value = T {};
+            return;
+        }
+        std::memcpy(&value, m_data.data() + m_pos - sizeof(T), sizeof(T));
+    }
+
+    void read(std::string& str)
+    {
+        uint32_t size = 0;
+        read(size);
+        if (!take(size)) {
+            str.clear();
+            return;
+        }
+        str.assign(m_data.data() + m_pos - size, size);
+    }
+
+    void read(asst::Rect& rect)
+    {
+        read(rect.x);
+        read(rect.y);
+        read(rect.width);
+        read(rect.height);
+    }
+
+    template <typename T, typename U>
+    void read(std::pair<T, U>& pair)
+    {
+        read(pair.first);
+        read(pair.second);
+    }
+
+    template <typename T, size_t N>
+    void read(std::array<T, N>& arr)
+    {
+        for (auto& elem : arr) {
+            read(elem);
+        }
+    }
+
+    template <typename... Ts>
+    void read(std::variant<Ts...>& var)
+    {
+        uint8_t index = 0;
+        read(index);
+        read_variant<0>(var, index);
+    }
+
+    template <typename T>
+    void read(std::vector<T>& vec)
+    {
+        uint32_t size = 0;
+        read(size);
+        // 每个元素至少占一个字节，防止坏文件申请一大块内存
+        if (size > m_data.size() - m_pos) {
+            m_ok = false;
+            return;
+        }
+        vec.clear();
+        vec.resize(size);
+        for (auto& elem : vec) {
+            read(elem);
+        }
+    }
+
+private:
+    bool take(size_t size)
+    {
+        if (!m_ok || size > m_data.size() - m_pos) {
+            m_ok = false;
+            return false;
+        }
+        m_pos += size;
+        return true;
+    }
+
+    template <size_t I, typename... Ts>
+    void read_variant(std::variant<Ts...>& var, uint8_t index)
+    {
+        if constexpr (I < sizeof...(Ts)) {
+            if (index == I) {
+                read(var.template emplace<I>());
+                return;
+            }
+            read_variant<I + 1>(var, index);
+        }
+        else {
+            m_ok = false;
+        }
+    }
+
+    std::string_view m_data;
+    size_t m_pos = 0;
+    bool m_ok = true;
+};
+} // namespace asst::utils
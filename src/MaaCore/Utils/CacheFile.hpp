@@ -0,0 +1,117 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <string>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+#include "Common/AsstVersion.h"
+
+namespace asst::utils
+{
+// 写缓存用的临时文件，带随机后缀。多个进程共用一个 UserDir 时不会写到同一个临时文件上
+inline std::filesystem::path unique_temp_path(const std::filesystem::path& path)
+{
+    static thread_local std::mt19937_64 rng { std::random_device {}() };
+    char suffix[32] = { 0 };
+    snprintf(suffix, sizeof(suffix), ".%016llx.tmp", static_cast<unsigned long long>(rng()));
+    auto temp_path = path;
+    temp_path += suffix;
+    return temp_path;
+}
+
+// 进程中途被杀掉时临时文件会留下来，名字每次都不一样，不会被覆盖，只能按时间清理
+inline void remove_stale_temp_files(const std::filesystem::path& dir)
+{
+    using namespace std::chrono_literals;
+    constexpr auto StaleTime = 24h;
+
+    std::error_code ec;
+    const auto now = std::filesystem::file_time_type::clock::now();
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+        if (!entry.is_regular_file(ec) || entry.path().extension() != ".tmp") {
+            continue;
+        }
+        const auto write_time = entry.last_write_time(ec);
+        if (!ec && now - write_time > StaleTime) {
+            std::filesystem::remove(entry.path(), ec);
+        }
+    }
+}
+
+// 当前 CPU 的指令集，ORT 优化出来的图和这个有关
+inline std::string cpu_features()
+{
+    bool avx = false;
+    bool avx2 = false;
+    bool fma = false;
+    bool avx512f = false;
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int info[4] = { 0 };
+    __cpuid(info, 0);
+    const int max_leaf = info[0];
+    __cpuid(info, 1);
+    fma = info[2] & (1 << 12);
+    avx = info[2] & (1 << 28);
+    if (max_leaf >= 7) {
+        __cpuidex(info, 7, 0);
+        avx2 = info[1] & (1 << 5);
+        avx512f = info[1] & (1 << 16);
+    }
+#elif (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    avx = __builtin_cpu_supports("avx");
+    avx2 = __builtin_cpu_supports("avx2");
+    fma = __builtin_cpu_supports("fma");
+    avx512f = __builtin_cpu_supports("avx512f");
+#endif
+
+#if defined(_M_X64) || defined(__x86_64__)
+    std::string features = "x64";
+#elif defined(_M_IX86) || defined(__i386__)
+    std::string features = "x86";
+#elif defined(_M_ARM64) || defined(__aarch64__)
+    std::string features = "arm64";
+#else
+    std::string features = "unknown";
+#endif
+    if (avx) {
+        features += "-avx";
+    }
+    if (avx2) {
+        features += "-avx2";
+    }
+    if (fma) {
+        features += "-fma";
+    }
+    if (avx512f) {
+        features += "-avx512f";
+    }
+    return features;
+}
+
+// 缓存对应的构建：版本、编译器和 CPU 指令集，任一不同都不应该复用别的构建写的缓存
+inline const std::string& build_identity()
+{
+    static const std::string identity = [] {
+        std::string compiler;
+#if defined(_MSC_VER)
+        compiler = "msvc" + std::to_string(_MSC_FULL_VER);
+#elif defined(__clang__)
+        compiler = "clang" __clang_version__;
+#elif defined(__GNUC__)
+        compiler = "gcc" __VERSION__;
+#else
+        compiler = "unknown";
+#endif
+        return std::string(Version) + "|" + compiler + "|" + cpu_features();
+    }();
+    return identity;
+}
+} // namespace asst::utils
@@ -1,10 +1,15 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <filesystem>
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <memory>
 #include <mutex>
+#include <sstream>
 #include <streambuf>
 #include <thread>
 #include <type_traits>
@@ -15,6 +20,7 @@
 #include "Locale.hpp"
 #include "Meta.hpp"
 #include "Platform.hpp"
+#include "Profiler.hpp"
 #include "Ranges.hpp"
 #include "SingletonHolder.hpp"
 #include "Time.hpp"
@@ -24,6 +30,23 @@
 #include <unistd.h>
 #endif
 
+#define ASST_LOG_LEVEL_DEBUG 0
+#define ASST_LOG_LEVEL_TRACE 1
+#define ASST_LOG_LEVEL_INFO 2
+#define ASST_LOG_LEVEL_WARN 3
+#define ASST_LOG_LEVEL_ERROR 4
+
+// 编译期的最低级别，低于它的 LogXxxLazy 调用连同参数一起被编译掉
+// ASST_LOG_LOCAL_MIN_LEVEL 用于按源文件（子系统）单独指定，优先于全局的 ASST_LOG_MIN_LEVEL
+#ifndef ASST_LOG_MIN_LEVEL
+#define ASST_LOG_MIN_LEVEL ASST_LOG_LEVEL_DEBUG
+#endif
+#ifdef ASST_LOG_LOCAL_MIN_LEVEL
+#define ASST_LOG_COMPILE_TIME_ENABLED(severity) ((severity) >= ASST_LOG_LOCAL_MIN_LEVEL)
+#else
+#define ASST_LOG_COMPILE_TIME_ENABLED(severity) ((severity) >= ASST_LOG_MIN_LEVEL)
+#endif
+
 namespace asst
 {
 template <typename Stream, typename T>
@@ -246,6 +269,80 @@ public:
 private:
     std::vector<id> m_state {};
 };
+
+// 有界的多生产者单消费者环形队列，生产者无锁；消费者需要由调用方保证同一时刻只有一个
+class log_ring_buffer
+{
+public:
+    static constexpr size_t Capacity = 8192;
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be power of 2");
+
+    log_ring_buffer()
+    {
+        for (size_t i = 0; i != Capacity; ++i) {
+            m_cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    log_ring_buffer(const log_ring_buffer&) = delete;
+    log_ring_buffer& operator=(const log_ring_buffer&) = delete;
+
+    // 队列满时返回 false，且不会 move 走 line
+    bool try_push(std::string& line)
+    {
+        size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        cell* c = nullptr;
+        while (true) {
+            c = &m_cells[pos & (Capacity - 1)];
+            const size_t seq = c->seq.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (diff < 0) {
+                return false;
+            }
+            else {
+                pos = m_enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        c->data = std::move(line);
+        c->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(std::string& line)
+    {
+        const size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        cell& c = m_cells[pos & (Capacity - 1)];
+        if (c.seq.load(std::memory_order_acquire) != pos + 1) {
+            return false;
+        }
+        line = std::move(c.data);
+        c.data.clear();
+        c.seq.store(pos + Capacity, std::memory_order_release);
+        m_dequeue_pos.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    size_t size_approx() const noexcept
+    {
+        return m_enqueue_pos.load(std::memory_order_relaxed) - m_dequeue_pos.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct cell
+    {
+        std::atomic_size_t seq = 0;
+        std::string data;
+    };
+
+    std::unique_ptr<cell[]> m_cells = std::make_unique<cell[]>(Capacity);
+    alignas(64) std::atomic_size_t m_enqueue_pos = 0;
+    alignas(64) std::atomic_size_t m_dequeue_pos = 0;
+};
 } // namespace detail
 
 class console_ostream
@@ -376,7 +473,8 @@ public:
         constexpr level(const level&) = default;
         constexpr level(level&&) noexcept = default;
 
-        constexpr explicit level(std::string_view s) noexcept :
+        constexpr explicit level(std::string_view s, int sev = ASST_LOG_LEVEL_TRACE) noexcept :
+            severity(sev),
             str(s)
         {
         }
@@ -391,6 +489,7 @@ public:
         }
 
         bool enabled = true;
+        int severity = ASST_LOG_LEVEL_TRACE;
 
         bool is_enabled() const { return enabled; }
 
@@ -428,7 +527,7 @@ public:
         template <typename _stream_t = stream_t>
         LogStream(std::mutex& mtx, _stream_t&& ofs, Logger::level lv) :
             m_trace_lock(mtx),
-            m_ofs(ofs)
+            m_ofs(std::forward<_stream_t>(ofs))
         {
             *this << lv;
         }
@@ -436,7 +535,7 @@ public:
         template <typename _stream_t = stream_t, typename... Args>
         LogStream(std::mutex& mtx, _stream_t&& ofs, Logger::level lv, Args&&... buff) :
             m_trace_lock(mtx),
-            m_ofs(ofs)
+            m_ofs(std::forward<_stream_t>(ofs))
         {
             ((*this << lv) << ... << std::forward<Args>(buff));
         }
@@ -444,7 +543,7 @@ public:
         template <typename _stream_t = stream_t, typename... Args>
         LogStream(std::unique_lock<std::mutex>&& lock, _stream_t&& ofs, Logger::level lv, Args&&... buff) :
             m_trace_lock(std::move(lock)),
-            m_ofs(ofs)
+            m_ofs(std::forward<_stream_t>(ofs))
         {
             ((*this << lv) << ... << std::forward<Args>(buff));
         }
@@ -557,6 +656,51 @@ public:
     template <typename stream_t, typename... Args>
     LogStream(std::unique_lock<std::mutex>&&, stream_t&&, Args&&...) -> LogStream<stream_t>;
 
+    // 一行日志的缓冲，析构时整行交给 Logger::commit
+    class LogRecord
+    {
+    public:
+        explicit LogRecord(Logger& logger) :
+            m_logger(&logger)
+        {
+        }
+
+        LogRecord(LogRecord&& rhs) noexcept :
+            m_logger(std::exchange(rhs.m_logger, nullptr)),
+            m_buff(std::move(rhs.m_buff))
+        {
+        }
+
+        LogRecord(const LogRecord&) = delete;
+        LogRecord& operator=(LogRecord&&) = delete;
+        LogRecord& operator=(const LogRecord&) = delete;
+
+        ~LogRecord()
+        {
+            if (m_logger) {
+                m_logger->commit(m_buff.str());
+            }
+        }
+
+        template <typename T>
+        requires has_stream_insertion_operator<std::ostream, T>
+        LogRecord& operator<<(T&& v)
+        {
+            m_buff << std::forward<T>(v);
+            return *this;
+        }
+
+        LogRecord& operator<<(std::ostream& (*pf)(std::ostream&))
+        {
+            m_buff << pf;
+            return *this;
+        }
+
+    private:
+        Logger* m_logger = nullptr;
+        std::ostringstream m_buff;
+    };
+
     class LogStreambuf : public std::filebuf
     {
     public:
@@ -615,7 +759,11 @@ public:
     };
 
 public:
-    virtual ~Logger() override { flush(); }
+    virtual ~Logger() override
+    {
+        set_async(false);
+        flush();
+    }
 
     // static bool set_directory(const std::filesystem::path& dir)
     // {
@@ -630,21 +778,16 @@ public:
     template <typename T>
     auto operator<<(T&& arg)
     {
-        std::unique_lock lock { m_trace_mutex };
-        rotate();
+        // 异步模式下整行格式化完再入队，不需要持有锁
+        std::unique_lock<std::mutex> lock;
+        if (!m_async.load(std::memory_order_relaxed)) {
+            lock = std::unique_lock { m_trace_mutex };
+        }
         if constexpr (std::same_as<level, remove_cvref_t<T>>) {
-#ifdef ASST_DEBUG
-            return LogStream(std::move(lock), ostreams { console_ostream(std::cout), m_of }, arg);
-#else
-            return LogStream(std::move(lock), m_of, arg);
-#endif
+            return LogStream(std::move(lock), LogRecord(*this), arg);
         }
         else {
-#ifdef ASST_DEBUG
-            return LogStream(std::move(lock), ostreams { console_ostream(std::cout), m_of }, level::trace, arg);
-#else
-            return LogStream(std::move(lock), m_of, level::trace, arg);
-#endif
+            return LogStream(std::move(lock), LogRecord(*this), level::trace, arg);
         }
     }
 
@@ -670,15 +813,26 @@ public:
     LOGGER_FUNC_WITH_LEVEL(warn)
     LOGGER_FUNC_WITH_LEVEL(error)
 
-    template <typename... Args>
-    inline void debug([[maybe_unused]] Args&&... args)
+    // debug 级别只在 ASST_DEBUG 或者存在 DEBUG.txt 时输出
+    static bool debug_enabled()
     {
 #ifdef ASST_DEBUG
-        constexpr bool need_log = true;
+        return true;
 #else
         static const bool need_log = std::filesystem::exists("DEBUG.txt");
+        return need_log;
 #endif
-        if (need_log) {
+    }
+
+    static bool need_log(const level& lv)
+    {
+        return lv.is_enabled() && (lv.severity != ASST_LOG_LEVEL_DEBUG || debug_enabled());
+    }
+
+    template <typename... Args>
+    inline void debug([[maybe_unused]] Args&&... args)
+    {
+        if (debug_enabled()) {
             std::unique_lock lock { m_trace_mutex };
             log(std::move(lock), level::debug, m_scopes.next(), std::forward<Args>(args)...);
         }
@@ -716,27 +870,47 @@ public:
         if (!lv.is_enabled()) {
             return;
         }
-        rotate();
-        (LogStream(
-             std::move(lock),
-#ifdef ASST_DEBUG
-             ostreams { console_ostream(std::cout), m_of },
-#else
-             m_of,
-#endif
-             lv)
-         << ... << std::forward<Args>(args));
+        (LogStream(std::move(lock), LogRecord(*this), lv) << ... << std::forward<Args>(args));
     }
 
     void flush()
     {
-        std::unique_lock<std::mutex> m_trace_lock(m_trace_mutex);
+        std::unique_lock<std::mutex> file_lock(m_file_mutex);
+        drain_async();
         if (m_ofs.is_open()) {
             m_of.flush();
             m_ofs.close();
         }
     }
 
+    // 异步模式：日志在调用线程格式化后放进无锁队列，由后台线程批量写入、定时 flush，文件轮转也在后台线程做
+    void set_async(bool enable)
+    {
+        std::unique_lock<std::mutex> switch_lock(m_async_switch_mutex);
+        if (enable == m_async.load()) {
+            return;
+        }
+        if (enable) {
+            m_async_running = true;
+            m_async_thread = std::thread(&Logger::async_proc, this);
+            m_async = true;
+            return;
+        }
+
+        m_async = false;
+        {
+            std::unique_lock<std::mutex> lock(m_async_mutex);
+            m_async_running = false;
+        }
+        m_async_cv.notify_one();
+        if (m_async_thread.joinable()) {
+            m_async_thread.join();
+        }
+        std::unique_lock<std::mutex> file_lock(m_file_mutex);
+        drain_async();
+        m_of.flush();
+    }
+
 private:
     friend class SingletonHolder<Logger>;
 
@@ -758,6 +932,71 @@ private:
         log_init_info();
     }
 
+    void commit(std::string line)
+    {
+        while (m_async.load(std::memory_order_relaxed)) {
+            if (m_async_buffer.try_push(line)) {
+                if (m_async_buffer.size_approx() > detail::log_ring_buffer::Capacity / 2) {
+                    wake_async_writer();
+                }
+                return;
+            }
+            // 队列满了，等后台线程消费；如果期间切回了同步模式，就直接写
+            wake_async_writer();
+            std::this_thread::yield();
+        }
+
+        std::unique_lock<std::mutex> file_lock(m_file_mutex);
+        write_line(line);
+        m_of.flush();
+    }
+
+    void write_line(const std::string& line)
+    {
+        rotate();
+#ifdef ASST_DEBUG
+        console_ostream(std::cout) << line << std::flush;
+#endif
+        m_of.write(line.data(), static_cast<std::streamsize>(line.size()));
+    }
+
+    // 调用方需持有 m_file_mutex
+    void drain_async()
+    {
+        std::string line;
+        while (m_async_buffer.try_pop(line)) {
+            write_line(line);
+        }
+    }
+
+    void wake_async_writer()
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_async_mutex);
+            m_async_wake = true;
+        }
+        m_async_cv.notify_one();
+    }
+
+    void async_proc()
+    {
+        bool running = true;
+        while (running) {
+            {
+                std::unique_lock<std::mutex> lock(m_async_mutex);
+                m_async_cv.wait_for(lock, AsyncFlushInterval, [&] { return m_async_wake || !m_async_running; });
+                m_async_wake = false;
+                running = m_async_running;
+            }
+            std::unique_lock<std::mutex> file_lock(m_file_mutex);
+            if (m_async_buffer.size_approx() == 0) {
+                continue;
+            }
+            drain_async();
+            m_of.flush();
+        }
+    }
+
     void rotate()
     {
         if (!m_of || !m_ofs || !m_ofs.is_open()) {
@@ -806,11 +1045,22 @@ private:
     std::filesystem::path m_log_path = m_directory / "debug" / "asst.log";
     std::filesystem::path m_log_bak_path = m_directory / "debug" / "asst.bak.log";
     std::mutex m_trace_mutex;
+    std::mutex m_file_mutex; // 保护下面的文件流，以及异步队列的消费端
     std::ofstream m_ofs;
     LogStreambuf m_buff;
     std::ostream m_of;
     std::size_t m_file_size = 0;
     const std::size_t MaxLogSize = 64LL * 1024 * 1024;
+
+    static constexpr auto AsyncFlushInterval = std::chrono::milliseconds(100);
+    std::atomic_bool m_async = false;
+    std::mutex m_async_switch_mutex;
+    std::mutex m_async_mutex;
+    std::condition_variable m_async_cv;
+    bool m_async_wake = false;
+    bool m_async_running = false;
+    std::thread m_async_thread;
+    detail::log_ring_buffer m_async_buffer;
 };
 
 inline constexpr Logger::separator Logger::separator::none;
@@ -819,11 +1069,11 @@ inline constexpr Logger::separator Logger::separator::tab("\t");
 inline constexpr Logger::separator Logger::separator::newline("\n");
 inline constexpr Logger::separator Logger::separator::comma(",");
 
-inline Logger::level Logger::level::debug("DBG");
-inline Logger::level Logger::level::trace("TRC");
-inline Logger::level Logger::level::info("INF");
-inline Logger::level Logger::level::warn("WRN");
-inline Logger::level Logger::level::error("ERR");
+inline Logger::level Logger::level::debug("DBG", ASST_LOG_LEVEL_DEBUG);
+inline Logger::level Logger::level::trace("TRC", ASST_LOG_LEVEL_TRACE);
+inline Logger::level Logger::level::info("INF", ASST_LOG_LEVEL_INFO);
+inline Logger::level Logger::level::warn("WRN", ASST_LOG_LEVEL_WARN);
+inline Logger::level Logger::level::error("ERR", ASST_LOG_LEVEL_ERROR);
 
 class LoggerAux
 {
@@ -842,7 +1092,11 @@ public:
 
     ~LoggerAux()
     {
-        const auto duration = std::chrono::steady_clock::now() - m_start_time;
+        const auto end_time = std::chrono::steady_clock::now();
+        const auto duration = end_time - m_start_time;
+        if (Profiler::get_instance().enabled()) {
+            Profiler::get_instance().record(m_func_name, "function", m_start_time, end_time);
+        }
 #ifdef ASST_DEBUG
         Logger::get_instance().pop(
             m_id,
@@ -879,6 +1133,20 @@ private:
 
 #define LogTraceScope LoggerAux _CatVarNameWithLine(_func_aux_)
 
+// 和 Log.xxx(...) 一样，但级别没有开启时不会对参数求值，适合每帧都会跑到的地方
+#define ASST_LOG_LAZY(lv, severity, ...)                               \
+    do {                                                               \
+        if constexpr (ASST_LOG_COMPILE_TIME_ENABLED(severity)) {       \
+            if (asst::Logger::need_log(asst::Logger::level::lv)) {     \
+                Log.lv(__VA_ARGS__);                                   \
+            }                                                          \
+        }                                                              \
+    } while (false)
+
+#define LogDebugLazy(...) ASST_LOG_LAZY(debug, ASST_LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define LogTraceLazy(...) ASST_LOG_LAZY(trace, ASST_LOG_LEVEL_TRACE, __VA_ARGS__)
+#define LogInfoLazy(...) ASST_LOG_LAZY(info, ASST_LOG_LEVEL_INFO, __VA_ARGS__)
+
 #ifndef _MSC_VER
 inline constexpr std::string_view summarize_pretty_function(std::string_view pf) // can be consteval?
 {
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace asst
+{
+// 定长的最近最少使用缓存，满了之后淘汰最久没被访问的
+// 本身不加锁，多线程使用时需要调用方自己保护
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache
+{
+public:
+    explicit LruCache(size_t capacity) :
+        m_capacity(capacity)
+    {
+    }
+
+    // 命中时会把它标记为最近使用。返回的指针在下一次 put / clear 之前有效
+    Value* get(const Key& key)
+    {
+        auto iter = m_index.find(key);
+        if (iter == m_index.end()) {
+            return nullptr;
+        }
+        m_items.splice(m_items.begin(), m_items, iter->second);
+        return &iter->second->second;
+    }
+
+    Value& put(const Key& key, Value value)
+    {
+        if (auto iter = m_index.find(key); iter != m_index.end()) {
+            iter->second->second = std::move(value);
+            m_items.splice(m_items.begin(), m_items, iter->second);
+            return iter->second->second;
+        }
+        if (m_capacity != 0 && m_items.size() >= m_capacity) {
+            m_index.erase(m_items.back().first);
+            m_items.pop_back();
+        }
+        m_items.emplace_front(key, std::move(value));
+        m_index.emplace(key, m_items.begin());
+        return m_items.front().second;
+    }
+
+    void clear()
+    {
+        m_index.clear();
+        m_items.clear();
+    }
+
+    size_t size() const noexcept { return m_items.size(); }
+
+private:
+    using Items = std::list<std::pair<Key, Value>>;
+
+    size_t m_capacity = 0;
+    Items m_items;
+    std::unordered_map<Key, typename Items::iterator, Hash> m_index;
+};
+} // namespace asst
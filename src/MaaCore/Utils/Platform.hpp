@@ -20,6 +20,7 @@ using platform::path_to_utf8_string;
 using platform::to_osstring;
 
 using platform::call_command;
+using platform::file_mapping;
 
 namespace path_literals
 {
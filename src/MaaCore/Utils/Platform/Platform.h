@@ -132,4 +132,48 @@ public:
 
     inline size_t size() const { return _ptr ? (page_size / sizeof(TElem)) : 0; }
 };
+
+// 只读的文件内存映射，同一个文件在多个进程间共享物理页。映射失败时 data() 为 nullptr
+class file_mapping
+{
+    const std::byte* _data = nullptr;
+    size_t _size = 0;
+#ifdef _WIN32
+    HANDLE _mapping = nullptr;
+#endif
+
+    void unmap() noexcept;
+
+public:
+    file_mapping() = default;
+    explicit file_mapping(const std::filesystem::path& path);
+    ~file_mapping() { unmap(); }
+
+    file_mapping(const file_mapping&) = delete;
+    file_mapping& operator=(const file_mapping&) = delete;
+
+    file_mapping(file_mapping&& other) noexcept { swap(other); }
+
+    file_mapping& operator=(file_mapping&& other) noexcept
+    {
+        unmap();
+        swap(other);
+        return *this;
+    }
+
+    void swap(file_mapping& other) noexcept
+    {
+        std::swap(_data, other._data);
+        std::swap(_size, other._size);
+#ifdef _WIN32
+        std::swap(_mapping, other._mapping);
+#endif
+    }
+
+    inline const std::byte* data() const noexcept { return _data; }
+
+    inline size_t size() const noexcept { return _size; }
+
+    inline explicit operator bool() const noexcept { return _data != nullptr; }
+};
 } // namespace asst::platform
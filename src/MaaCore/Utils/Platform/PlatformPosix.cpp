@@ -4,6 +4,8 @@
 
 #include <cstdlib>
 #include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
@@ -24,6 +26,33 @@ void asst::platform::aligned_free(void* ptr)
     ::free(ptr);
 }
 
+asst::platform::file_mapping::file_mapping(const std::filesystem::path& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* addr = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        if (addr != MAP_FAILED) {
+            _data = static_cast<const std::byte*>(addr);
+            _size = static_cast<size_t>(st.st_size);
+        }
+    }
+    // 映射建立之后就不再需要文件描述符了
+    ::close(fd);
+}
+
+void asst::platform::file_mapping::unmap() noexcept
+{
+    if (_data) {
+        ::munmap(const_cast<std::byte*>(_data), _size);
+        _data = nullptr;
+        _size = 0;
+    }
+}
+
 std::string asst::platform::call_command(const std::string& cmdline, bool* exit_flag)
 {
     constexpr int PipeBuffSize = 4096;
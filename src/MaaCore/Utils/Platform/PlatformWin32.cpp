@@ -28,6 +28,52 @@ void asst::platform::aligned_free(void* ptr)
     _aligned_free(ptr);
 }
 
+asst::platform::file_mapping::file_mapping(const std::filesystem::path& path)
+{
+    HANDLE file = CreateFileW(
+        path.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_DELETE,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return;
+    }
+
+    LARGE_INTEGER file_size {};
+    if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+        _mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (_mapping) {
+            void* addr = MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+            if (addr) {
+                _data = static_cast<const std::byte*>(addr);
+                _size = static_cast<size_t>(file_size.QuadPart);
+            }
+            else {
+                CloseHandle(_mapping);
+                _mapping = nullptr;
+            }
+        }
+    }
+    // 映射对象会持有文件，这里可以直接关掉
+    CloseHandle(file);
+}
+
+void asst::platform::file_mapping::unmap() noexcept
+{
+    if (_data) {
+        UnmapViewOfFile(_data);
+        _data = nullptr;
+        _size = 0;
+    }
+    if (_mapping) {
+        CloseHandle(_mapping);
+        _mapping = nullptr;
+    }
+}
+
 bool asst::win32::CreateOverlappablePipe(
     HANDLE* read,
     HANDLE* write,
@@ -0,0 +1,259 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Platform.hpp"
+#include "SingletonHolder.hpp"
+
+#if defined(__APPLE__) || defined(__linux__)
+#include <unistd.h>
+#endif
+
+namespace asst
+{
+// 区间耗时记录器，开启后每个 ProfileScope / LogTraceFunction 都会记到所在线程的缓冲里
+// 导出为 Chrome trace 格式，可以用 chrome://tracing 或 https://ui.perfetto.dev 打开
+class Profiler : public SingletonHolder<Profiler>
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    struct Span
+    {
+        std::string name;
+        std::string_view category; // 只接受字面量
+        int64_t start_us = 0;
+        int64_t dur_us = 0;
+    };
+
+    virtual ~Profiler() override = default;
+
+    bool enabled() const noexcept { return m_enabled.load(std::memory_order_relaxed); }
+
+    // 清空之前的记录并开始
+    void start()
+    {
+        std::unique_lock<std::mutex> lock(m_buffers_mutex);
+        for (const auto& buffer : m_buffers) {
+            std::unique_lock<std::mutex> buffer_lock(buffer->mutex);
+            buffer->spans.clear();
+        }
+        m_exited_spans.clear();
+        m_span_count = 0;
+        m_origin = clock::now().time_since_epoch().count();
+        m_enabled = true;
+    }
+
+    // 停止记录，并把已有的记录导出到 path
+    bool stop_and_export(const std::filesystem::path& path)
+    {
+        m_enabled = false;
+
+        std::error_code ec;
+        std::filesystem::create_directories(path.parent_path(), ec);
+        std::ofstream ofs(path, std::ios::out | std::ios::trunc);
+        if (!ofs.is_open()) {
+            return false;
+        }
+
+        const auto pid =
+#ifdef _WIN32
+            _getpid();
+#else
+            ::getpid();
+#endif
+
+        ofs << R"({"displayTimeUnit":"ms","traceEvents":[)";
+        bool first = true;
+        auto write_spans = [&](const std::vector<Span>& spans, uint64_t tid) {
+            for (const Span& span : spans) {
+                if (!first) {
+                    ofs << ",";
+                }
+                first = false;
+                ofs << "\n{\"name\":\"" << escape(span.name) << "\",\"cat\":\"" << escape(span.category)
+                    << "\",\"ph\":\"X\",\"ts\":" << span.start_us << ",\"dur\":" << span.dur_us << ",\"pid\":" << pid
+                    << ",\"tid\":" << tid << "}";
+            }
+        };
+        std::unique_lock<std::mutex> lock(m_buffers_mutex);
+        for (const auto& buffer : m_buffers) {
+            std::unique_lock<std::mutex> buffer_lock(buffer->mutex);
+            write_spans(buffer->spans, buffer->tid);
+        }
+        for (const auto& [tid, spans] : m_exited_spans) {
+            write_spans(spans, tid);
+        }
+        ofs << "\n]}\n";
+        return ofs.good();
+    }
+
+    void record(std::string_view name, std::string_view category, clock::time_point start, clock::time_point end)
+    {
+        const clock::time_point origin { clock::duration(m_origin.load(std::memory_order_relaxed)) };
+        if (!enabled() || start < origin) {
+            return;
+        }
+        // 防止忘了关导致内存无限增长，超过上限的直接丢掉
+        if (m_span_count.fetch_add(1, std::memory_order_relaxed) >= MaxSpans) {
+            return;
+        }
+        using namespace std::chrono;
+        ThreadBuffer& buffer = local_buffer();
+        std::unique_lock<std::mutex> lock(buffer.mutex); // 只有导出的时候才会有竞争
+        buffer.spans.emplace_back(Span {
+            .name = std::string(name),
+            .category = category,
+            .start_us = duration_cast<microseconds>(start - origin).count(),
+            .dur_us = duration_cast<microseconds>(end - start).count(),
+        });
+    }
+
+private:
+    friend class SingletonHolder<Profiler>;
+
+    Profiler() = default;
+
+    struct ThreadBuffer
+    {
+        std::mutex mutex;
+        std::vector<Span> spans;
+        uint64_t tid = 0;
+    };
+
+    // 线程退出时把记录交回给 Profiler，并把缓冲从 m_buffers 里去掉
+    // 不然每个 std::async 之类的短命线程都会留下一个缓冲，直到进程退出
+    class LocalBuffer
+    {
+    public:
+        explicit LocalBuffer(Profiler& profiler) :
+            m_profiler(profiler),
+            m_buffer(std::make_shared<ThreadBuffer>())
+        {
+            // 和日志里的 Tx 保持一致，方便对照
+            m_buffer->tid =
+#ifdef _WIN32
+                ::GetCurrentThreadId();
+#else
+                static_cast<unsigned short>(std::hash<std::thread::id> {}(std::this_thread::get_id()));
+#endif
+            std::unique_lock<std::mutex> lock(m_profiler.m_buffers_mutex);
+            m_profiler.m_buffers.emplace_back(m_buffer);
+        }
+
+        ~LocalBuffer() { m_profiler.release_buffer(m_buffer); }
+
+        LocalBuffer(const LocalBuffer&) = delete;
+        LocalBuffer& operator=(const LocalBuffer&) = delete;
+
+        ThreadBuffer& buffer() { return *m_buffer; }
+
+    private:
+        Profiler& m_profiler;
+        std::shared_ptr<ThreadBuffer> m_buffer;
+    };
+
+    ThreadBuffer& local_buffer()
+    {
+        thread_local LocalBuffer buffer(*this);
+        return buffer.buffer();
+    }
+
+    void release_buffer(const std::shared_ptr<ThreadBuffer>& buffer)
+    {
+        std::unique_lock<std::mutex> lock(m_buffers_mutex);
+        std::erase(m_buffers, buffer);
+
+        std::unique_lock<std::mutex> buffer_lock(buffer->mutex);
+        // 没开的时候 spans 是空的，什么都不会留下；开着的时候总量受 MaxSpans 限制
+        if (!buffer->spans.empty()) {
+            m_exited_spans.emplace_back(buffer->tid, std::move(buffer->spans));
+        }
+    }
+
+    static std::string escape(std::string_view str)
+    {
+        std::string result;
+        result.reserve(str.size());
+        for (char c : str) {
+            switch (c) {
+            case '"':
+                result += "\\\"";
+                break;
+            case '\\':
+                result += "\\\\";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    result += ' ';
+                }
+                else {
+                    result += c;
+                }
+                break;
+            }
+        }
+        return result;
+    }
+
+    static constexpr size_t MaxSpans = 2'000'000;
+
+    std::atomic_bool m_enabled = false;
+    std::atomic_size_t m_span_count = 0;
+    std::atomic<clock::rep> m_origin = clock::time_point::max().time_since_epoch().count();
+    std::mutex m_buffers_mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+    std::vector<std::pair<uint64_t, std::vector<Span>>> m_exited_spans; // 已退出的线程留下的记录
+};
+
+class ProfileScopeGuard
+{
+public:
+    ProfileScopeGuard(std::string_view name, std::string_view category) :
+        m_name(name),
+        m_category(category)
+    {
+        if (Profiler::get_instance().enabled()) {
+            m_start = Profiler::clock::now();
+            m_recording = true;
+        }
+    }
+
+    ~ProfileScopeGuard()
+    {
+        if (m_recording) {
+            Profiler::get_instance().record(m_name, m_category, m_start, Profiler::clock::now());
+        }
+    }
+
+    ProfileScopeGuard(const ProfileScopeGuard&) = delete;
+    ProfileScopeGuard(ProfileScopeGuard&&) = delete;
+    ProfileScopeGuard& operator=(const ProfileScopeGuard&) = delete;
+    ProfileScopeGuard& operator=(ProfileScopeGuard&&) = delete;
+
+private:
+    std::string_view m_name;
+    std::string_view m_category;
+    Profiler::clock::time_point m_start;
+    bool m_recording = false;
+};
+
+#define _ProfileCat_(a, b) a##b
+#define _ProfileCat(a, b) _ProfileCat_(a, b)
+
+// name 需要在作用域结束前一直有效，category 只接受字面量
+#define ProfileScope(name, category) \
+    ::asst::ProfileScopeGuard _ProfileCat(_profile_scope_, __LINE__)(name, category)
+} // namespace asst
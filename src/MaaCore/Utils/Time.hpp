@@ -42,8 +42,9 @@ inline std::string get_format_time()
     struct timeval tv = {};
     gettimeofday(&tv, nullptr);
     time_t nowtime = tv.tv_sec;
-    struct tm* tm_info = localtime(&nowtime);
-    auto offset = strftime(buff, sizeof(buff), "%Y-%m-%d %H:%M:%S", tm_info);
+    struct tm tm_info = {};
+    localtime_r(&nowtime, &tm_info); // 异步日志会在多个线程同时调用，localtime 不可重入
+    auto offset = strftime(buff, sizeof(buff), "%Y-%m-%d %H:%M:%S", &tm_info);
     sprintf(buff + offset, ".%03ld", static_cast<long int>(tv.tv_usec / 1000));
 #endif // END _WIN32
     return buff;
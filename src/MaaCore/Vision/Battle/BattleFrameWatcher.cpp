@@ -0,0 +1,71 @@
+#include "BattleFrameWatcher.h"
+
+#include "Utils/NoWarningCV.h"
+
+namespace
+{
+// 缩小的倍数，费用数字只有几十个像素高，再小就看不出变化了
+constexpr int ThumbnailScale = 4;
+// 缩略图上灰度差超过这个值的像素才算变了，压掉模拟器画面的一点噪声
+constexpr double PixelThreshold = 20;
+// 变了的像素至少要有这么多个，部署栏里一个冷却数字跳一下大概有十几个
+constexpr int MinChangedPixels = 4;
+}
+
+bool asst::BattleFrameWatcher::region_changed(const std::string& key, const cv::Mat& image, const Rect& roi)
+{
+    cv::Mat cur = thumbnail(image, roi);
+    auto iter = m_regions.find(key);
+    if (iter != m_regions.end() && iter->second.roi == roi && !differs(iter->second.image, cur)) {
+        return false;
+    }
+    m_regions[key] = Thumbnail { roi, std::move(cur) };
+    return true;
+}
+
+void asst::BattleFrameWatcher::invalidate(const std::string& key)
+{
+    m_regions.erase(key);
+}
+
+bool asst::BattleFrameWatcher::frame_changed(const cv::Mat& image)
+{
+    cv::Mat cur = thumbnail(image, Rect(0, 0, image.cols, image.rows));
+    const bool changed = m_prev_frame.empty() || differs(m_prev_frame, cur);
+    m_prev_frame = std::move(cur);
+    return changed;
+}
+
+void asst::BattleFrameWatcher::clear()
+{
+    m_regions.clear();
+    m_prev_frame = cv::Mat();
+}
+
+cv::Mat asst::BattleFrameWatcher::thumbnail(const cv::Mat& image, const Rect& roi)
+{
+    const cv::Rect rect = make_rect<cv::Rect>(roi) & cv::Rect(0, 0, image.cols, image.rows);
+    if (rect.empty()) {
+        return {};
+    }
+    cv::Mat gray;
+    cv::cvtColor(image(rect), gray, cv::COLOR_BGR2GRAY);
+    cv::Mat result;
+    const cv::Size size(std::max(rect.width / ThumbnailScale, 1), std::max(rect.height / ThumbnailScale, 1));
+    cv::resize(gray, result, size, 0, 0, cv::INTER_AREA);
+    return result;
+}
+
+bool asst::BattleFrameWatcher::differs(const cv::Mat& lhs, const cv::Mat& rhs)
+{
+    if (lhs.size() != rhs.size()) {
+        return true;
+    }
+    if (lhs.empty()) {
+        return false;
+    }
+    cv::Mat diff;
+    cv::absdiff(lhs, rhs, diff);
+    cv::threshold(diff, diff, PixelThreshold, 255, cv::THRESH_BINARY);
+    return cv::countNonZero(diff) >= MinChangedPixels;
+}
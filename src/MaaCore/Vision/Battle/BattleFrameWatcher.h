@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+
+#include "Common/AsstTypes.h"
+#include "Utils/NoWarningCVMat.h"
+
+namespace asst
+{
+// 战斗画面的变化检测，按区域比较缩略图，区域没变化时就不用重新跑这块的识别
+// 每个区域和它上一次被判定为变化时的画面比，所以缓慢的变化攒多了也能被发现
+class BattleFrameWatcher
+{
+public:
+    // 区域变化够大时返回 true，并记下当前画面作为之后比较的基准
+    // 第一次见到的区域，或者 roi 变了的区域，都算作变化
+    bool region_changed(const std::string& key, const cv::Mat& image, const Rect& roi);
+    // 忘掉这个区域，下次一定算作变化。识别结果这次没能用上、下一帧还要再识别时调用
+    void invalidate(const std::string& key);
+    // 和上一次调用时的整幅画面比
+    bool frame_changed(const cv::Mat& image);
+    void clear();
+
+private:
+    struct Thumbnail
+    {
+        Rect roi;
+        cv::Mat image;
+    };
+
+    static cv::Mat thumbnail(const cv::Mat& image, const Rect& roi);
+    static bool differs(const cv::Mat& lhs, const cv::Mat& rhs);
+
+    std::unordered_map<std::string, Thumbnail> m_regions;
+    cv::Mat m_prev_frame;
+};
+} // namespace asst
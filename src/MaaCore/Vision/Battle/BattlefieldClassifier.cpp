@@ -69,7 +69,10 @@ BattlefieldClassifier::SkillReadyResult BattlefieldClassifier::skill_ready_analy
     constexpr const char* output_names[] = { "output" }; // session.GetOutputName()
 
     Ort::RunOptions run_options;
-    session.Run(run_options, input_names, &input_tensor, 1, output_names, &output_tensor, 1);
+    {
+        ProfileScope("onnx inference", "onnx");
+        session.Run(run_options, input_names, &input_tensor, 1, output_names, &output_tensor, 1);
+    }
     Log.info(__FUNCTION__, "raw results:", raw_results);
 
     SkillReadyResult::Prob prob = softmax(raw_results);
@@ -176,7 +179,10 @@ BattlefieldClassifier::DeployDirectionResult BattlefieldClassifier::deploy_direc
     constexpr const char* output_names[] = { "output" }; // session.GetOutputName()
 
     Ort::RunOptions run_options;
-    session.Run(run_options, input_names, &input_tensor, 1, output_names, &output_tensor, 1);
+    {
+        ProfileScope("onnx inference", "onnx");
+        session.Run(run_options, input_names, &input_tensor, 1, output_names, &output_tensor, 1);
+    }
     Log.info(__FUNCTION__, "raw result:", raw_results);
 
     DeployDirectionResult::Prob prob = softmax(raw_results);
@@ -61,13 +61,17 @@ std::vector<BattlefieldDetector::OperatorResult> BattlefieldDetector::operator_a
     std::vector output_names = { output_name.c_str() };
 
     Ort::RunOptions run_options;
-    auto output_tensors = session.Run(
-        run_options,
-        input_names.data(),
-        &input_tensor,
-        input_names.size(),
-        output_names.data(),
-        output_names.size());
+    std::vector<Ort::Value> output_tensors;
+    {
+        ProfileScope("onnx inference", "onnx");
+        output_tensors = session.Run(
+            run_options,
+            input_names.data(),
+            &input_tensor,
+            input_names.size(),
+            output_names.data(),
+            output_names.size());
+    }
 
     const float* raw_output = output_tensors[0].GetTensorData<float>();
     // output_shape is { 1, 5, 8400 }
@@ -9,9 +9,9 @@
 #include "Config/TemplResource.h"
 #include "Utils/Logger.hpp"
 #include "Vision/BestMatcher.h"
+#include "Vision/DigitOCRer.h"
 #include "Vision/Matcher.h"
 #include "Vision/MultiMatcher.h"
-#include "Vision/RegionOCRer.h"
 #include "Vision/TemplDetOCRer.h"
 
 using namespace asst;
@@ -216,16 +216,18 @@ bool BattlefieldMatcher::oper_cooling_analyze(const Rect& roi) const
 int BattlefieldMatcher::oper_cost_analyze(const Rect& roi) const
 {
     int cost = -1;
-    RegionOCRer cost_analyzer(m_image, roi);
+    DigitOCRer cost_analyzer(m_image, roi);
     cost_analyzer.set_replace(Task.get<OcrTaskInfo>("NumberOcrReplace")->replace_map);
     cost_analyzer.set_use_char_model(true);
     cost_analyzer.set_bin_threshold(80, 255);
-    if (!cost_analyzer.analyze()) {
+    cost_analyzer.set_glyph_set("BattleOperCost");
+    auto cost_opt = cost_analyzer.analyze();
+    if (!cost_opt) {
         Log.warn("oper cost analyze failed");
         return cost;
     }
-    if (!utils::chars_to_number(cost_analyzer.get_result().text, cost)) {
-        Log.warn("oper cost convert failed, str:", cost_analyzer.get_result().text);
+    if (!utils::chars_to_number(cost_opt->text, cost)) {
+        Log.warn("oper cost convert failed, str:", cost_opt->text);
         return cost;
     }
     return cost;
@@ -271,6 +273,7 @@ std::optional<std::pair<int, int>> BattlefieldMatcher::kills_analyze() const
     TemplDetOCRer kills_analyzer(m_image);
     kills_analyzer.set_task_info("BattleKillsFlag", "BattleKills");
     kills_analyzer.set_replace(Task.get<OcrTaskInfo>("NumberOcrReplace")->replace_map);
+    kills_analyzer.set_digit_glyph_set("BattleKills");
 
     auto kills_opt = kills_analyzer.analyze();
     if (!kills_opt) {
@@ -334,9 +337,10 @@ bool BattlefieldMatcher::cost_symbol_analyze() const
 
 std::optional<int> BattlefieldMatcher::costs_analyze() const
 {
-    RegionOCRer cost_analyzer(m_image);
+    DigitOCRer cost_analyzer(m_image);
     cost_analyzer.set_task_info("BattleCostData");
     cost_analyzer.set_replace(Task.get<OcrTaskInfo>("NumberOcrReplace")->replace_map);
+    cost_analyzer.set_glyph_set("BattleCostData");
 
     auto cost_opt = cost_analyzer.analyze();
     if (!cost_opt) {
@@ -17,6 +17,7 @@ void BestMatcher::append_templ(std::string name, const cv::Mat& templ)
 
 BestMatcher::ResultOpt BestMatcher::analyze() const
 {
+    ProfileScope("BestMatcher::analyze", "vision");
     Matcher match_analyzer(m_image, m_roi);
     match_analyzer.set_params(m_params);
 #ifdef ASST_DEBUG
@@ -26,6 +27,7 @@ BestMatcher::ResultOpt BestMatcher::analyze() const
 #endif
 
     Result result;
+    double second_score = 0.0;
     for (const auto& templ_info : m_templs) {
         auto&& [name, templ] = templ_info;
 
@@ -42,16 +44,21 @@ BestMatcher::ResultOpt BestMatcher::analyze() const
         }
         const auto& cur_matched = cur_opt.value();
         if (result.score < cur_matched.score) {
+            second_score = result.score;
             result = Result { .rect = cur_matched.rect, .score = cur_matched.score, .templ_info = templ_info };
         }
+        else if (second_score < cur_matched.score) {
+            second_score = cur_matched.score;
+        }
     }
 
     if (!result.score) {
         return std::nullopt;
     }
+    result.second_score = second_score;
 
     if (m_log_tracing) {
-        Log.trace("The best match is", result.to_string(), result.templ_info.name);
+        LogTraceLazy("The best match is", result.to_string(), result.templ_info.name);
     }
     m_result = std::move(result);
     return m_result;
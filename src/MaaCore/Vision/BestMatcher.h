@@ -23,6 +23,7 @@ public:
         Rect rect;
         double score = 0.0;
         TemplInfo templ_info;
+        double second_score = 0.0; // 次好的模板的得分，没过阈值的模板不算
     };
 
     using ResultOpt = std::optional<Result>;
@@ -19,6 +19,11 @@ void MatcherConfig::set_task_info(const std::string& task_name)
     set_task_info(Task.get(task_name));
 }
 
+void MatcherConfig::set_task_info(const MatchTaskInfo& task_info)
+{
+    _set_task_info(task_info);
+}
+
 void MatcherConfig::set_templ(std::variant<std::string, cv::Mat> templ)
 {
     m_params.templs = { std::move(templ) };
@@ -64,15 +69,15 @@ void MatcherConfig::set_method(MatchMethod method) noexcept
     m_params.methods = { method };
 }
 
-void MatcherConfig::_set_task_info(MatchTaskInfo task_info)
+void MatcherConfig::_set_task_info(const MatchTaskInfo& task_info)
 {
     m_params.templs.clear();
     ranges::copy(task_info.templ_names, std::back_inserter(m_params.templs));
-    m_params.templ_thres = std::move(task_info.templ_thresholds);
-    m_params.mask_ranges = std::move(task_info.mask_ranges);
-    m_params.color_scales = std::move(task_info.color_scales);
+    m_params.templ_thres = task_info.templ_thresholds;
+    m_params.mask_ranges = task_info.mask_ranges;
+    m_params.color_scales = task_info.color_scales;
     m_params.color_close = task_info.color_close;
-    m_params.methods = std::move(task_info.methods);
+    m_params.methods = task_info.methods;
 
     _set_roi(task_info.roi);
 }
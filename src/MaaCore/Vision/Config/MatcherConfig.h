@@ -30,6 +30,7 @@ public:
 
     void set_task_info(const std::shared_ptr<TaskInfo>& task_ptr);
     void set_task_info(const std::string& task_name);
+    void set_task_info(const MatchTaskInfo& task_info);
 
     void set_templ(std::variant<std::string, cv::Mat> templ);
     // void set_templ(std::vector<std::variant<std::string, cv::Mat>> templs);
@@ -43,7 +44,7 @@ public:
 protected:
     virtual void _set_roi(const Rect& roi) = 0;
 
-    void _set_task_info(MatchTaskInfo task_info);
+    void _set_task_info(const MatchTaskInfo& task_info);
 
 protected:
     Params m_params;
@@ -29,27 +29,14 @@ void OCRerConfig::set_replace(
     m_params.replace.clear();
     m_params.replace.reserve(replace.size());
 
-    for (auto&& [key, val] : replace) {
-        auto& ocr_config = OcrConfig::get_instance();
-        std::string new_key = key;
-        for (const auto& eq_class : ocr_config.get_eq_classes()) {
-            if (eq_class.size() <= 1) {
-                continue;
-            }
-
-            // eq_class: [s, S] -> regex: "(?:s|S)"
-            std::string eq_classes_regex = "(?:";
-            for (const auto& elem : eq_class) {
-                (eq_classes_regex += elem) += '|';
-            }
-            eq_classes_regex.pop_back();
-            eq_classes_regex += ')';
-            ranges::for_each(eq_class, [&](std::string_view elem) {
-                utils::string_replace_all_in_place(new_key, elem, eq_classes_regex);
-            });
+    auto& ocr_config = OcrConfig::get_instance();
+    for (const auto& [key, val] : replace) {
+        auto regex = ocr_config.get_replace_regex(key);
+        if (!regex) {
+            continue;
         }
         // do not create new_val as val is user-provided, and can avoid issues like 夕 and katakana タ
-        m_params.replace.emplace_back(std::move(new_key), val);
+        m_params.replace.emplace_back(Replace { .regex = std::move(regex), .new_str = val });
     }
     m_params.replace_full = replace_full;
 }
@@ -64,6 +51,11 @@ void OCRerConfig::set_task_info(const std::string& task_name)
     set_task_info(Task.get(task_name));
 }
 
+void OCRerConfig::set_task_info(const OcrTaskInfo& task_info)
+{
+    _set_task_info(task_info);
+}
+
 void asst::OCRerConfig::set_without_det(bool without_det) noexcept
 {
     m_params.without_det = without_det;
@@ -91,9 +83,9 @@ void asst::OCRerConfig::set_bin_trim_threshold(int left, int right)
     m_params.bin_right_trim_threshold = right;
 }
 
-void OCRerConfig::_set_task_info(OcrTaskInfo task_info)
+void OCRerConfig::_set_task_info(const OcrTaskInfo& task_info)
 {
-    set_required(std::move(task_info.text));
+    set_required(task_info.text);
     m_params.full_match = task_info.full_match;
     set_replace(task_info.replace_map, task_info.replace_full);
     m_params.use_char_model = task_info.is_ascii;
@@ -3,18 +3,27 @@
 #include "Common/AsstTypes.h"
 #include "Utils/NoWarningCVMat.h"
 
+#include <memory>
 #include <variant>
 
 namespace asst
 {
+struct OcrReplaceRegex;
+
 class OCRerConfig
 {
 public:
+    struct Replace
+    {
+        std::shared_ptr<const OcrReplaceRegex> regex; // 由 OcrConfig 编译并缓存
+        std::string new_str;
+    };
+
     struct Params
     {
         std::vector<std::pair<std::string, std::string>> required; // raw, equivalent
         bool full_match = false;
-        std::vector<std::pair<std::string, std::string>> replace;
+        std::vector<Replace> replace;
         bool replace_full = false;
         bool without_det = false;
         bool use_char_model = false;
@@ -39,6 +48,7 @@ public:
 
     virtual void set_task_info(std::shared_ptr<TaskInfo> task_ptr);
     virtual void set_task_info(const std::string& task_name);
+    void set_task_info(const OcrTaskInfo& task_info);
 
     void set_without_det(bool without_det) noexcept;
     void set_use_char_model(bool enable) noexcept;
@@ -49,7 +59,7 @@ public:
 
 protected:
     virtual void _set_roi(const Rect& roi) = 0;
-    virtual void _set_task_info(OcrTaskInfo task_info);
+    virtual void _set_task_info(const OcrTaskInfo& task_info);
 
 protected:
     Params m_params;
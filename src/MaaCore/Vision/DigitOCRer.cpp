@@ -0,0 +1,264 @@
+#include "DigitOCRer.h"
+
+#include <climits>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+
+#include "Utils/NoWarningCV.h"
+
+#include "Hasher.h"
+#include "Utils/Logger.hpp"
+
+using namespace asst;
+
+namespace
+{
+struct GlyphSample
+{
+    DigitOCRer::Glyph glyph;
+    char ch = 0;
+    int confirmations = 1; // OCR 给出同一个字符的次数
+};
+
+struct GlyphSet
+{
+    std::vector<GlyphSample> samples;
+    bool ready = false; // 所有数字都有可信的样本了才走字形匹配
+};
+
+// 所有实例共享，同一个位置的数字在不同实例上字形是一样的
+struct GlyphLibrary
+{
+    std::shared_mutex mutex;
+    std::unordered_map<std::string, GlyphSet> glyph_sets;
+};
+
+GlyphLibrary& glyph_library()
+{
+    static GlyphLibrary library;
+    return library;
+}
+
+constexpr int GlyphSize = 16;
+constexpr int MinGlyphPixels = 3;
+constexpr int MaxHamming = 24;       // 256 位里最多差多少位
+constexpr int MinHammingMargin = 8;  // 最近的其他字符至少要再远这么多
+constexpr float MaxShapeDiff = 0.15f;
+constexpr size_t MaxSamplesPerChar = 8;
+// 单次 OCR 可能认错，同一个字形要被 OCR 认成同一个字符这么多次才信
+constexpr int MinConfirmations = 3;
+// 没学过的数字会被认成最像的那个学过的，所以要等这些字符都学会了才用字形
+constexpr std::string_view RequiredChars = "0123456789";
+
+bool shape_compatible(const DigitOCRer::Glyph& lhs, const DigitOCRer::Glyph& rhs)
+{
+    return std::abs(lhs.aspect - rhs.aspect) <= MaxShapeDiff && std::abs(lhs.height - rhs.height) <= MaxShapeDiff;
+}
+
+bool trusted(const GlyphSample& sample)
+{
+    return sample.confirmations >= MinConfirmations;
+}
+
+bool glyph_set_ready(const GlyphSet& glyph_set)
+{
+    return ranges::all_of(RequiredChars, [&](char ch) {
+        return ranges::any_of(glyph_set.samples, [&](const GlyphSample& s) { return s.ch == ch && trusted(s); });
+    });
+}
+
+// 返回最像的数字和距离，不够确定时字符为 0
+// 最像的必须是可信的数字样本，且比任何其他字符的样本（包括还没确认的、'.'、'K' 之类的）都近出一截
+// 附近没有其他字符时按 MaxHamming 处有一个算，没学过的字（比如“万”）离哪个数字都不会很近
+std::pair<char, int> match_glyph(const std::vector<GlyphSample>& samples, const DigitOCRer::Glyph& glyph)
+{
+    int best_dist = INT_MAX;
+    char best_ch = 0;
+    for (const auto& sample : samples) {
+        if (!trusted(sample) || RequiredChars.find(sample.ch) == std::string_view::npos ||
+            !shape_compatible(glyph, sample.glyph)) {
+            continue;
+        }
+        if (int dist = DigitOCRer::hamming(glyph, sample.glyph); dist < best_dist) {
+            best_dist = dist;
+            best_ch = sample.ch;
+        }
+    }
+    if (best_dist > MaxHamming) {
+        return { 0, best_dist };
+    }
+
+    int second_dist = MaxHamming;
+    for (const auto& sample : samples) {
+        if (sample.ch == best_ch || !shape_compatible(glyph, sample.glyph)) {
+            continue;
+        }
+        second_dist = std::min(second_dist, DigitOCRer::hamming(glyph, sample.glyph));
+    }
+    if (second_dist - best_dist < MinHammingMargin) {
+        return { 0, best_dist };
+    }
+    return { best_ch, best_dist };
+}
+}
+
+DigitOCRer::ResultOpt DigitOCRer::analyze() const
+{
+    if (m_glyph_set.empty()) {
+        return RegionOCRer::analyze();
+    }
+
+    cv::Mat bin = binarize();
+    auto bounding_rect = make_rect<Rect>(cv::boundingRect(bin));
+    if (bounding_rect.empty()) {
+        return std::nullopt;
+    }
+    auto glyphs = split_glyphs(bin);
+
+    auto& library = glyph_library();
+    std::string text;
+    double score = 1.0;
+    if (!glyphs.empty()) {
+        std::shared_lock lock(library.mutex);
+        auto set_iter = library.glyph_sets.find(m_glyph_set);
+        if (set_iter != library.glyph_sets.end() && set_iter->second.ready) {
+            const auto& samples = set_iter->second.samples;
+            for (const auto& glyph : glyphs) {
+                auto [best_ch, best_dist] = match_glyph(samples, glyph);
+                if (best_ch == 0) {
+                    text.clear();
+                    break;
+                }
+                text += best_ch;
+                score = std::min(score, 1.0 - static_cast<double>(best_dist) / (GlyphSize * GlyphSize));
+            }
+        }
+    }
+
+    if (!text.empty()) {
+        Result result;
+        result.text = std::move(text);
+        result.score = score;
+        result.rect = Rect(
+            m_roi.x + bounding_rect.x - m_params.bin_expansion,
+            m_roi.y + bounding_rect.y - m_params.bin_expansion,
+            bounding_rect.width + 2 * m_params.bin_expansion,
+            bounding_rect.height + 2 * m_params.bin_expansion);
+        // 学的是 OCR 后处理之后的字符，replace 已经体现在字形里了，只差 required
+        if (!OCRer::filter_by_required(result, m_params)) {
+            return std::nullopt;
+        }
+        if (m_log_tracing) {
+            Log.trace(m_glyph_set, result, "by glyphs");
+        }
+        m_result = result;
+        return result;
+    }
+
+    auto result_opt = RegionOCRer::analyze();
+    if (!result_opt) {
+        return std::nullopt;
+    }
+
+    // 非全匹配的 required 会把文字换成 required 本身，和字形对不上
+    if (!m_params.required.empty() && !m_params.full_match) {
+        return result_opt;
+    }
+    // 字符数对得上才学，对不上说明切分或者 OCR 有一个是错的
+    const std::string& ocr_text = result_opt->text;
+    if (ocr_text.size() != glyphs.size() ||
+        !ranges::all_of(ocr_text, [](char c) -> bool { return c > ' ' && c <= '~'; })) {
+        return result_opt;
+    }
+
+    std::unique_lock lock(library.mutex);
+    auto& glyph_set = library.glyph_sets[m_glyph_set];
+    auto& samples = glyph_set.samples;
+    for (size_t i = 0; i != glyphs.size(); ++i) {
+        const auto& glyph = glyphs[i];
+        const char ch = ocr_text[i];
+        size_t same_char_count = 0;
+        auto nearest_iter = samples.end();
+        int nearest_dist = INT_MAX;
+        for (auto iter = samples.begin(); iter != samples.end(); ++iter) {
+            same_char_count += iter->ch == ch;
+            if (!shape_compatible(glyph, iter->glyph)) {
+                continue;
+            }
+            if (int dist = hamming(glyph, iter->glyph); dist < nearest_dist) {
+                nearest_dist = dist;
+                nearest_iter = iter;
+            }
+        }
+
+        // 和已有的样本几乎一样：字符也一样就多一次确认；字符不一样说明 OCR 有一次认错了，这个样本不能再信
+        if (nearest_iter != samples.end() && nearest_dist <= MinHammingMargin / 2) {
+            if (nearest_iter->ch == ch) {
+                nearest_iter->confirmations = std::min(nearest_iter->confirmations + 1, MinConfirmations);
+            }
+            else {
+                Log.warn(m_glyph_set, "glyph conflict", nearest_iter->ch, ch);
+                samples.erase(nearest_iter);
+            }
+            continue;
+        }
+        if (same_char_count >= MaxSamplesPerChar) {
+            continue;
+        }
+        samples.emplace_back(GlyphSample { .glyph = glyph, .ch = ch });
+    }
+    glyph_set.ready = glyph_set_ready(glyph_set);
+
+    return result_opt;
+}
+
+int DigitOCRer::hamming(const Glyph& lhs, const Glyph& rhs)
+{
+    return Hasher::hamming(lhs.bits, rhs.bits);
+}
+
+cv::Mat DigitOCRer::binarize() const
+{
+    // 和 RegionOCRer::analyze 保持一致，保证切出来的字符和 OCR 的结果一一对应
+    cv::Mat img_roi = make_roi(m_image, m_roi);
+    cv::Mat img_roi_gray;
+    cv::cvtColor(img_roi, img_roi_gray, cv::COLOR_BGR2GRAY);
+    cv::Mat bin;
+    cv::inRange(img_roi_gray, m_params.bin_threshold_lower, m_params.bin_threshold_upper, bin);
+
+    bin_left_trim(bin);
+    bin_right_trim(bin);
+    return bin;
+}
+
+std::vector<DigitOCRer::Glyph> DigitOCRer::split_glyphs(const cv::Mat& bin)
+{
+    const int line_height = cv::boundingRect(bin).height;
+    if (line_height <= 0) {
+        return {};
+    }
+
+    std::vector<Glyph> glyphs;
+    for (const cv::Mat& range_img : Hasher::split_bin(bin)) {
+        if (cv::countNonZero(range_img) < MinGlyphPixels) {
+            continue;
+        }
+        cv::Mat bounded = Hasher::bound_bin(range_img);
+
+        Glyph glyph;
+        glyph.aspect = static_cast<float>(bounded.cols) / static_cast<float>(bounded.rows);
+        glyph.height = static_cast<float>(bounded.rows) / static_cast<float>(line_height);
+
+        cv::Mat resized;
+        cv::resize(bounded, resized, cv::Size(GlyphSize, GlyphSize));
+        for (int i = 0; i != GlyphSize * GlyphSize; ++i) {
+            if (resized.at<uchar>(i / GlyphSize, i % GlyphSize) > 127) {
+                glyph.bits[i / 64] |= 1ULL << (i % 64);
+            }
+        }
+        glyphs.emplace_back(glyph);
+    }
+    return glyphs;
+}
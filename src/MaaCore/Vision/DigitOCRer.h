@@ -0,0 +1,39 @@
+#pragma once
+#include "RegionOCRer.h"
+
+#include "Hasher.h"
+
+namespace asst
+{
+// 数字专用的快速识别器
+// 按 Hasher::split_bin 把二值图切成单个字符，与已学习的字形做 hamming 匹配
+// 字形库由 OCR 的结果在线学习，字形被 OCR 多次认成同一个字符才可信，0-9 都可信之后才走字形匹配
+// 任一字符不能确定是数字时（包括“万”、“.”、“K” 这些）回退到 RegionOCRer
+class DigitOCRer : public RegionOCRer
+{
+public:
+    using RegionOCRer::RegionOCRer;
+    virtual ~DigitOCRer() override = default;
+
+    virtual ResultOpt analyze() const override;
+
+    // 不同位置的数字字体、字号都不一样，按名字分开学习；为空则直接走 OCR
+    void set_glyph_set(std::string name) { m_glyph_set = std::move(name); }
+
+    struct Glyph
+    {
+        Hasher::Hash bits {}; // 16x16 二值缩略图
+        float aspect = 0;     // 宽高比
+        float height = 0;     // 相对于整行的高度，用来区分 '.' 之类的小字符
+    };
+
+    static int hamming(const Glyph& lhs, const Glyph& rhs);
+
+protected:
+    cv::Mat binarize() const;
+    static std::vector<Glyph> split_glyphs(const cv::Mat& bin);
+
+private:
+    std::string m_glyph_set;
+};
+}
@@ -1,5 +1,7 @@
 #include "Hasher.h"
 
+#include <bit>
+
 #include "Utils/NoWarningCV.h"
 
 #include "Utils/Logger.hpp"
@@ -7,6 +9,7 @@
 bool asst::Hasher::analyze()
 {
     m_hash_result.clear();
+    m_packed_hash_result.clear();
     m_min_dist_name.clear();
 
     cv::Mat roi = m_image(make_rect<cv::Rect>(m_roi));
@@ -32,21 +35,15 @@ bool asst::Hasher::analyze()
         if (m_need_bound) {
             to_hash = bound_bin(to_hash);
         }
-        std::string hash_result = s_hash(to_hash);
-        // Log.debug(hash_result);
+        Hash hash_result = p_hash(to_hash);
 
-        int min_dist = INT_MAX;
         std::string cur_min_dist_name;
-        for (auto&& [name, templ] : m_hash_templates) {
-            int hm = hamming(hash_result, templ);
-            // Log.debug(name, "dist:", hm);
-            if (hm < min_dist) {
-                cur_min_dist_name = name;
-                min_dist = hm;
-            }
+        if (auto match = m_template_index.nearest(hash_result)) {
+            cur_min_dist_name = m_template_names[match->id];
         }
         m_min_dist_name.emplace_back(std::move(cur_min_dist_name));
-        m_hash_result.emplace_back(std::move(hash_result));
+        m_hash_result.emplace_back(to_string(hash_result));
+        m_packed_hash_result.emplace_back(hash_result);
     }
 
     return true;
@@ -64,7 +61,13 @@ void asst::Hasher::set_mask_range(std::pair<int, int> mask_range) noexcept
 
 void asst::Hasher::set_hash_templates(std::unordered_map<std::string, std::string> hash_templates) noexcept
 {
-    m_hash_templates = std::move(hash_templates);
+    m_template_names.clear();
+    m_template_index.clear();
+    m_template_names.reserve(hash_templates.size());
+    for (auto&& [name, templ] : hash_templates) {
+        m_template_index.insert(from_string(templ), m_template_names.size());
+        m_template_names.emplace_back(name);
+    }
 }
 
 void asst::Hasher::set_need_split(bool need_split) noexcept
@@ -87,9 +90,16 @@ const std::vector<std::string>& asst::Hasher::get_hash() const noexcept
     return m_hash_result;
 }
 
-std::string asst::Hasher::s_hash(const cv::Mat& img)
+const std::vector<asst::Hasher::Hash>& asst::Hasher::get_packed_hash() const noexcept
+{
+    return m_packed_hash_result;
+}
+
+asst::Hasher::Hash asst::Hasher::p_hash(const cv::Mat& img)
 {
     static constexpr int HashKernelSize = 16;
+    static_assert(HashKernelSize * HashKernelSize == sizeof(Hash) * CHAR_BIT);
+
     cv::Mat resized;
     cv::resize(img, resized, cv::Size(HashKernelSize, HashKernelSize));
     if (img.channels() == 3) {
@@ -97,21 +107,61 @@ std::string asst::Hasher::s_hash(const cv::Mat& img)
         cv::cvtColor(resized, temp, cv::COLOR_BGR2GRAY);
         resized = temp;
     }
-    std::stringstream hash_value;
-    uchar* pix = resized.data;
-    int tmp_dec = 0;
-    for (int ro = 0; ro < 256; ro++) {
-        tmp_dec = tmp_dec << 1;
+    Hash hash {};
+    const uchar* pix = resized.data;
+    for (int i = 0; i < HashKernelSize * HashKernelSize; ++i, ++pix) {
         if (*pix > 127) {
-            tmp_dec++;
+            hash[i / 64] |= 1ULL << (63 - i % 64);
+        }
+    }
+    return hash;
+}
+
+std::string asst::Hasher::s_hash(const cv::Mat& img)
+{
+    return to_string(p_hash(img));
+}
+
+asst::Hasher::Hash asst::Hasher::from_string(std::string_view hash_str) noexcept
+{
+    static constexpr size_t HexDigits = sizeof(Hash) * 2;
+
+    // 和旧的字符串 hash 保持一致：不足的位数在左边补 0
+    Hash hash {};
+    if (hash_str.size() > HexDigits) {
+        hash_str = hash_str.substr(hash_str.size() - HexDigits);
+    }
+    const size_t offset = HexDigits - hash_str.size();
+    for (size_t i = 0; i != hash_str.size(); ++i) {
+        const char c = hash_str[i];
+        uint64_t nibble = 0;
+        if (c >= '0' && c <= '9') {
+            nibble = c - '0';
         }
-        if (ro % 4 == 3) {
-            hash_value << std::hex << tmp_dec;
-            tmp_dec = 0;
+        else if (c >= 'a' && c <= 'f') {
+            nibble = c - 'a' + 10;
         }
-        pix++;
+        else if (c >= 'A' && c <= 'F') {
+            nibble = c - 'A' + 10;
+        }
+        const size_t pos = offset + i;
+        hash[pos / 16] |= nibble << ((15 - pos % 16) * 4);
     }
-    return hash_value.str();
+    return hash;
+}
+
+std::string asst::Hasher::to_string(const Hash& hash)
+{
+    static constexpr char HexChars[] = "0123456789abcdef";
+
+    std::string result;
+    result.reserve(sizeof(Hash) * 2);
+    for (uint64_t word : hash) {
+        for (int shift = 60; shift >= 0; shift -= 4) {
+            result += HexChars[(word >> shift) & 0xf];
+        }
+    }
+    return result;
 }
 
 std::vector<cv::Mat> asst::Hasher::split_bin(const cv::Mat& bin)
@@ -154,20 +204,90 @@ cv::Mat asst::Hasher::bound_bin(const cv::Mat& bin)
     return bin(cv::boundingRect(bin));
 }
 
-int asst::Hasher::hamming(std::string hash1, std::string hash2)
+int asst::Hasher::hamming(const Hash& hash1, const Hash& hash2) noexcept
 {
-    static constexpr int HammingFlags = 64;
-
-    hash1.insert(hash1.begin(), HammingFlags - hash1.size(), '0');
-    hash2.insert(hash2.begin(), HammingFlags - hash2.size(), '0');
     int dist = 0;
-    for (int i = 0; i < HammingFlags; i = i + 16) {
-        unsigned long long x =
-            strtoull(hash1.substr(i, 16).c_str(), nullptr, 16) ^ strtoull(hash2.substr(i, 16).c_str(), nullptr, 16);
-        while (x) {
-            ++dist;
-            x = x & (x - 1);
-        }
+    for (size_t i = 0; i != hash1.size(); ++i) {
+        dist += std::popcount(hash1[i] ^ hash2[i]);
     }
     return dist;
 }
+
+int asst::Hasher::hamming(const std::string& hash1, const std::string& hash2)
+{
+    return hamming(from_string(hash1), from_string(hash2));
+}
+
+void asst::HashIndex::insert(const Hash& hash, size_t id)
+{
+    if (m_nodes.empty()) {
+        m_nodes.emplace_back(Node { .hash = hash, .id = id, .children = {} });
+        return;
+    }
+
+    size_t cur = 0;
+    while (true) {
+        const int dist = Hasher::hamming(m_nodes[cur].hash, hash);
+        auto& children = m_nodes[cur].children;
+        auto child_iter = ranges::find(children, dist, [](const auto& child) { return child.first; });
+        if (child_iter == children.end()) {
+            children.emplace_back(dist, m_nodes.size());
+            m_nodes.emplace_back(Node { .hash = hash, .id = id, .children = {} });
+            return;
+        }
+        cur = child_iter->second;
+    }
+}
+
+std::optional<asst::HashIndex::Match> asst::HashIndex::nearest(const Hash& hash, int max_dist) const
+{
+    std::optional<Match> best;
+    if (m_nodes.empty()) {
+        return best;
+    }
+
+    std::vector<size_t> to_visit = { 0 };
+    while (!to_visit.empty()) {
+        const Node& node = m_nodes[to_visit.back()];
+        to_visit.pop_back();
+
+        const int dist = Hasher::hamming(node.hash, hash);
+        if (dist <= max_dist && (!best || dist < best->dist || (dist == best->dist && node.id < best->id))) {
+            best = Match { .id = node.id, .dist = dist };
+        }
+        // 三角不等式：子树里的点到 hash 的距离不小于 |child_dist - dist|
+        const int bound = best ? best->dist : max_dist;
+        for (const auto& [child_dist, child_index] : node.children) {
+            if (std::abs(child_dist - dist) <= bound) {
+                to_visit.emplace_back(child_index);
+            }
+        }
+    }
+    return best;
+}
+
+std::vector<asst::HashIndex::Match> asst::HashIndex::within(const Hash& hash, int radius) const
+{
+    std::vector<Match> result;
+    if (m_nodes.empty()) {
+        return result;
+    }
+
+    std::vector<size_t> to_visit = { 0 };
+    while (!to_visit.empty()) {
+        const Node& node = m_nodes[to_visit.back()];
+        to_visit.pop_back();
+
+        const int dist = Hasher::hamming(node.hash, hash);
+        if (dist <= radius) {
+            result.emplace_back(Match { .id = node.id, .dist = dist });
+        }
+        for (const auto& [child_dist, child_index] : node.children) {
+            if (std::abs(child_dist - dist) <= radius) {
+                to_visit.emplace_back(child_index);
+            }
+        }
+    }
+    ranges::sort(result, std::less {}, std::mem_fn(&Match::id));
+    return result;
+}
@@ -1,14 +1,54 @@
 #pragma once
 #include "VisionHelper.h"
 
+#include <array>
+#include <climits>
+#include <cstdint>
+#include <optional>
 #include <unordered_map>
 
 namespace asst
 {
+// BK 树，按 hamming 距离做最近邻 / 半径查询，插入的 id 由调用方自己维护含义
+class HashIndex
+{
+public:
+    using Hash = std::array<uint64_t, 4>;
+
+    struct Match
+    {
+        size_t id = 0;
+        int dist = 0;
+    };
+
+    void insert(const Hash& hash, size_t id);
+    void clear() noexcept { m_nodes.clear(); }
+    bool empty() const noexcept { return m_nodes.empty(); }
+    size_t size() const noexcept { return m_nodes.size(); }
+
+    // 距离相同时返回 id 较小的
+    std::optional<Match> nearest(const Hash& hash, int max_dist = INT_MAX) const;
+    // 距离 <= radius 的所有结果，按 id 排序
+    std::vector<Match> within(const Hash& hash, int radius) const;
+
+private:
+    struct Node
+    {
+        Hash hash {};
+        size_t id = 0;
+        std::vector<std::pair<int, size_t>> children; // 到子节点的距离, 子节点下标
+    };
+
+    std::vector<Node> m_nodes;
+};
+
 // FIXME: 删掉这个类，以及对应的 task 类型
 class Hasher : public VisionHelper
 {
 public:
+    // 16x16 的二值缩略图，按像素顺序从高位到低位打包，和 s_hash 的十六进制串一一对应
+    using Hash = HashIndex::Hash;
+
     using VisionHelper::VisionHelper;
     virtual ~Hasher() override = default;
 
@@ -22,19 +62,26 @@ public:
 
     const std::vector<std::string>& get_min_dist_name() const noexcept;
     const std::vector<std::string>& get_hash() const noexcept;
+    const std::vector<Hash>& get_packed_hash() const noexcept;
 
+    static Hash p_hash(const cv::Mat& img);
     static std::string s_hash(const cv::Mat& img);
-    static int hamming(std::string hash1, std::string hash2);
+    static Hash from_string(std::string_view hash_str) noexcept;
+    static std::string to_string(const Hash& hash);
+    static int hamming(const Hash& hash1, const Hash& hash2) noexcept;
+    static int hamming(const std::string& hash1, const std::string& hash2);
     static std::vector<cv::Mat> split_bin(const cv::Mat& bin);
     static cv::Mat bound_bin(const cv::Mat& bin);
 
 protected:
     std::pair<int, int> m_mask_range;
-    std::unordered_map<std::string, std::string> m_hash_templates;
+    std::vector<std::string> m_template_names;
+    HashIndex m_template_index;
     bool m_need_split = false;
     bool m_need_bound = false;
 
     std::vector<std::string> m_hash_result;
+    std::vector<Hash> m_packed_hash_result;
     std::vector<std::string> m_min_dist_name;
 };
 }
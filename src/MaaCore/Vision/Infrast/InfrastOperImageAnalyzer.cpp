@@ -5,6 +5,7 @@
 
 #include "Config/Miscellaneous/InfrastConfig.h"
 #include "Config/TaskData.h"
+#include "InfrastSkillIndex.h"
 #include "InfrastSmileyImageAnalyzer.h"
 #include "Utils/Logger.hpp"
 #include "Vision/Hasher.h"
@@ -22,6 +23,8 @@ bool asst::InfrastOperImageAnalyzer::analyze()
     if (m_to_be_calced & Smiley) {
         oper_detect();
     }
+    // 心情、头像 hash 和技能识别比较费时间，上一张图识别过的就不再识别了
+    auto carried = take_carried_opers();
     if (m_to_be_calced & Mood) {
         mood_analyze();
     }
@@ -31,6 +34,7 @@ bool asst::InfrastOperImageAnalyzer::analyze()
     if (m_to_be_calced & Skill) {
         skill_analyze();
     }
+    restore_carried_opers(std::move(carried));
     if (m_to_be_calced & Selected) {
         selected_analyze();
     }
@@ -75,6 +79,55 @@ void asst::InfrastOperImageAnalyzer::sort_by_mood()
     });
 }
 
+std::vector<std::optional<asst::infrast::Oper>> asst::InfrastOperImageAnalyzer::take_carried_opers()
+{
+    std::vector<std::optional<infrast::Oper>> carried(m_result.size());
+    if (m_carried_opers.empty()) {
+        return carried;
+    }
+
+    // 偏移是按整张图估计的，笑脸的位置差几个像素都算同一个
+    constexpr int MaxPosDiff = 5;
+    std::vector<infrast::Oper> fresh;
+    for (size_t i = 0; i < m_result.size(); ++i) {
+        auto& oper = m_result[i];
+        auto iter = ranges::find_if(m_carried_opers, [&](const infrast::Oper& pre) {
+            return pre.smiley.type == oper.smiley.type &&
+                   std::abs(pre.smiley.rect.x - oper.smiley.rect.x) <= MaxPosDiff &&
+                   std::abs(pre.smiley.rect.y - oper.smiley.rect.y) <= MaxPosDiff;
+        });
+        if (iter == m_carried_opers.end()) {
+            fresh.emplace_back(std::move(oper));
+            continue;
+        }
+        oper.mood_ratio = iter->mood_ratio;
+        oper.face_hash = iter->face_hash;
+        oper.skills = iter->skills;
+        carried[i] = std::move(oper);
+    }
+    Log.trace(__FUNCTION__, "| carried", m_result.size() - fresh.size(), "fresh", fresh.size());
+    m_result = std::move(fresh);
+    return carried;
+}
+
+void asst::InfrastOperImageAnalyzer::restore_carried_opers(std::vector<std::optional<infrast::Oper>> carried)
+{
+    std::vector<infrast::Oper> merged;
+    merged.reserve(carried.size());
+    auto fresh_iter = m_result.begin();
+    for (auto& oper : carried) {
+        if (!oper) {
+            merged.emplace_back(std::move(*fresh_iter++));
+            continue;
+        }
+        if (!oper->skills.empty()) {
+            ++m_num_of_opers_with_skills;
+        }
+        merged.emplace_back(std::move(*oper));
+    }
+    m_result = std::move(merged);
+}
+
 void asst::InfrastOperImageAnalyzer::oper_detect()
 {
     LogTraceFunction;
@@ -215,7 +268,7 @@ void asst::InfrastOperImageAnalyzer::face_hash_analyze()
         Rect roi = oper.smiley.rect.move(hash_rect_move);
         hash_analyzer.set_roi(roi);
         hash_analyzer.analyze();
-        oper.face_hash = hash_analyzer.get_hash().front();
+        oper.face_hash = hash_analyzer.get_packed_hash().front();
     }
 }
 
@@ -232,7 +285,12 @@ void asst::InfrastOperImageAnalyzer::skill_analyze()
     skill_analyzer.set_threshold(task_ptr->templ_thresholds.front());
     skill_analyzer.set_method(task_ptr->methods.front());
 
-    for (auto&& oper : m_result) {
+    // 先把所有干员亮着的技能图标都裁剪出来，一起粗筛
+    std::vector<size_t> icon_opers;
+    std::vector<Rect> icon_rects;
+    std::vector<cv::Mat> icon_images;
+    for (size_t oper_index = 0; oper_index < m_result.size(); ++oper_index) {
+        const auto& oper = m_result[oper_index];
         Rect roi = task_ptr->rect_move;
         roi.x += oper.smiley.rect.x;
         roi.y += oper.smiley.rect.y;
@@ -248,7 +306,6 @@ void asst::InfrastOperImageAnalyzer::skill_analyze()
         }
 
         cv::Mat all_skills_img = m_image(make_rect<cv::Rect>(roi));
-        std::string log_str = "[ ";
         for (int i = 0; i != MaxNumOfSkills; ++i) {
             int x = i * skill_width + spacing * i;
             Rect skill_rect_in_roi(x, 0, skill_width, roi.height);
@@ -268,77 +325,86 @@ void asst::InfrastOperImageAnalyzer::skill_analyze()
 #ifdef ASST_DEBUG
             cv::rectangle(m_image_draw, make_rect<cv::Rect>(skill_rect), cv::Scalar(0, 255, 0), 2);
 #endif
+            icon_opers.emplace_back(oper_index);
+            icon_rects.emplace_back(skill_rect);
+            icon_images.emplace_back(skill_image);
+        }
+    }
 
-            // 针对裁剪出来的每个技能进行识别
-            skill_analyzer.set_roi(skill_rect);
+    // 每个图标只和最像的几种技能做模板匹配
+    constexpr size_t ShortlistSize = 3;
+    const auto shortlists = InfrastSkillIndex::get_instance().shortlist(m_facility, icon_images, ShortlistSize);
+    const auto& all_skills = InfrastData.get_skills(m_facility);
 
-            std::vector<std::pair<infrast::Skill, MatchRect>> possible_skills;
-            // 逐个该设施内所有可能的技能，取得分最高的
-            for (const auto& skill : InfrastData.get_skills(m_facility) | views::values) {
-                skill_analyzer.set_templ(skill.templ_name);
+    std::vector<std::string> log_strs(m_result.size(), "[ ");
+    for (size_t icon_index = 0; icon_index < icon_rects.size(); ++icon_index) {
+        // 针对裁剪出来的每个技能进行识别
+        skill_analyzer.set_roi(icon_rects[icon_index]);
 
-                if (!skill_analyzer.analyze()) {
-                    continue;
-                }
+        std::vector<std::pair<infrast::Skill, MatchRect>> possible_skills;
+        auto match_skill = [&](const infrast::Skill& skill) {
+            skill_analyzer.set_templ(skill.templ_name);
+            if (skill_analyzer.analyze()) {
                 possible_skills.emplace_back(std::make_pair(skill, skill_analyzer.get_result()));
             }
-            if (possible_skills.empty()) {
-                Log.error("skill has no recognition result");
-                continue;
-            }
-            // 可能的结果多于1个，只可能是同一个技能不同等级的结果
-            // 例如：标准化a、标准化b，这两个模板非常像，然后分数都超过了阈值
-            // 如果原图是标准化a，是不可能匹配上标准化b的模板的，因为b的模板左半边多了半个环
-            // 相反如果原图是标准化b，却有可能匹配上标准化a的模板，因为a的模板右半边的环，b的原图中也有
-            // 所以如果结果是同类型的，只需要取里面等级最高的那个即可
-            infrast::Skill most_confident_skills;
-            if (possible_skills.size() == 1) {
-                most_confident_skills = possible_skills.front().first;
+        };
+        for (const std::string& skill_id : shortlists[icon_index]) {
+            match_skill(all_skills.at(skill_id));
+        }
+        // 粗筛不可靠（候选为空）或者候选都没匹配上，再逐个该设施内所有可能的技能，取得分最高的
+        if (possible_skills.empty()) {
+            for (const auto& skill : all_skills | views::values) {
+                match_skill(skill);
             }
-            else if (possible_skills.size() > 1) {
-                // 匹配得分最高的id作为基准，排除有识别错误，其他的技能混进来了的情况
-                // 即排除容器中，除了有同一个技能的不同等级，还有别的技能的情况
-                auto max_iter = ranges::max_element(possible_skills, std::less {}, [](const auto& pair) {
-                    return pair.second.score;
-                });
-                double base_score = max_iter->second.score;
-                std::string base_id = max_iter->first.id;
-                size_t level_pos = 0;
-                // 倒着找，第一个不是数字的。前面就是技能基础id名字，后面的数字就是技能等级
-                for (size_t j = base_id.size() - 1; j != 0; --j) {
-                    if (!std::isdigit(base_id.at(j))) {
-                        level_pos = j + 1;
-                        break;
-                    }
+        }
+        if (possible_skills.empty()) {
+            Log.error("skill has no recognition result");
+            continue;
+        }
+        // 可能的结果多于1个，只可能是同一个技能不同等级的结果
+        // 例如：标准化a、标准化b，这两个模板非常像，然后分数都超过了阈值
+        // 如果原图是标准化a，是不可能匹配上标准化b的模板的，因为b的模板左半边多了半个环
+        // 相反如果原图是标准化b，却有可能匹配上标准化a的模板，因为a的模板右半边的环，b的原图中也有
+        // 所以如果结果是同类型的，只需要取里面等级最高的那个即可
+        infrast::Skill most_confident_skills;
+        if (possible_skills.size() == 1) {
+            most_confident_skills = possible_skills.front().first;
+        }
+        else if (possible_skills.size() > 1) {
+            // 匹配得分最高的id作为基准，排除有识别错误，其他的技能混进来了的情况
+            // 即排除容器中，除了有同一个技能的不同等级，还有别的技能的情况
+            auto max_iter = ranges::max_element(possible_skills, std::less {}, [](const auto& pair) {
+                return pair.second.score;
+            });
+            double base_score = max_iter->second.score;
+            // 前面是技能基础id名字，后面的数字就是技能等级
+            std::string base_id = InfrastSkillIndex::base_id(max_iter->first.id);
+            std::string max_level;
+            for (const auto& [skill, skill_mr] : possible_skills) {
+                // 得分差距过大的，直接忽略
+                if (base_score - skill_mr.score > 0.05) {
+                    continue;
                 }
-                base_id = base_id.substr(0, level_pos);
-                std::string max_level;
-                for (const auto& [skill, skill_mr] : possible_skills) {
-                    // 得分差距过大的，直接忽略
-                    if (base_score - skill_mr.score > 0.05) {
-                        continue;
+                if (size_t find_pos = skill.id.find(base_id); find_pos != std::string::npos) {
+                    std::string cur_skill_level = skill.id.substr(base_id.size());
+                    if (max_level.empty() || cur_skill_level > max_level) {
+                        max_level = cur_skill_level;
+                        most_confident_skills = skill;
                     }
-                    if (size_t find_pos = skill.id.find(base_id); find_pos != std::string::npos) {
-                        std::string cur_skill_level = skill.id.substr(base_id.size());
-                        if (max_level.empty() || cur_skill_level > max_level) {
-                            max_level = cur_skill_level;
-                            most_confident_skills = skill;
-                        }
-                    } // 这里对应的else就是上述的其他技能混进来了的情况
-                }
+                } // 这里对应的else就是上述的其他技能混进来了的情况
             }
-            Log.trace(most_confident_skills.id, most_confident_skills.names.front());
-            std::string skill_id = most_confident_skills.id;
-            log_str += skill_id + " - " + most_confident_skills.names.front() + "; ";
-#ifdef ASST_DEBUG
-            cv::Mat skill_mat = m_image(make_rect<cv::Rect>(skill_rect));
-#endif
-            oper.skills.emplace(std::move(most_confident_skills));
         }
-        if (!oper.skills.empty()) {
+        Log.trace(most_confident_skills.id, most_confident_skills.names.front());
+        std::string skill_id = most_confident_skills.id;
+        log_strs[icon_opers[icon_index]] += skill_id + " - " + most_confident_skills.names.front() + "; ";
+        m_result[icon_opers[icon_index]].skills.emplace(std::move(most_confident_skills));
+    }
+
+    for (size_t oper_index = 0; oper_index < m_result.size(); ++oper_index) {
+        if (!m_result[oper_index].skills.empty()) {
             ++m_num_of_opers_with_skills;
         }
-        Log.trace(log_str, "]");
+        Log.trace(log_strs[oper_index], "]");
     }
 }
 
@@ -3,6 +3,8 @@
 
 #include "Common/AsstInfrastDef.h"
 
+#include <optional>
+
 namespace asst
 {
 class InfrastOperImageAnalyzer : public VisionHelper
@@ -38,6 +40,10 @@ public:
 
     void set_to_be_calced(int to_be_calced) noexcept { m_to_be_calced = to_be_calced | Smiley; }
 
+    // 上一张图中识别过的干员，位置需要先换算到当前图中（参考 ScrollTracker）
+    // 位置对得上的干员直接沿用心情、头像 hash 和技能，不再重复识别
+    void set_carried_opers(std::vector<infrast::Oper> opers) noexcept { m_carried_opers = std::move(opers); }
+
     static constexpr int MaxNumOfSkills = 2; // 单个干员最多有几个基建技能
 
 private:
@@ -51,9 +57,14 @@ private:
     void selected_analyze();
     void doing_analyze();
 
+    // 把能沿用结果的干员从 m_result 中取出来，返回的和原来的 m_result 一一对应，不能沿用的是 nullopt
+    std::vector<std::optional<infrast::Oper>> take_carried_opers();
+    void restore_carried_opers(std::vector<std::optional<infrast::Oper>> carried);
+
     std::string m_facility;
     std::vector<infrast::Oper> m_result;
     int m_to_be_calced = Smiley;
     int m_num_of_opers_with_skills = 0;
+    std::vector<infrast::Oper> m_carried_opers;
 };
 } // namespace asst
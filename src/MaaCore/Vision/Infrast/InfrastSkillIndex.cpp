@@ -0,0 +1,159 @@
+#include "InfrastSkillIndex.h"
+
+#include <cctype>
+#include <unordered_set>
+
+#include "Utils/NoWarningCV.h"
+
+#include "Config/Miscellaneous/InfrastConfig.h"
+#include "Config/TemplResource.h"
+#include "Utils/Logger.hpp"
+#include "Utils/Ranges.hpp"
+
+namespace
+{
+// 缩成这么大的灰度图再比较，足够区分不同的技能，也能容忍几个像素的错位
+constexpr int FeatureSide = 16;
+// 粗筛只能保证相似度排得靠前，长得像的技能会把真正的技能挤出候选，而候选里的又能通过模板匹配
+// 所以最像的要足够像，且候选里最不像的那种和候选外最像的那种要拉开差距，否则就全部匹配一遍
+constexpr float MinSimilarity = 0.8F;
+constexpr float MinSimilarityMargin = 0.1F;
+}
+
+std::string asst::InfrastSkillIndex::base_id(const std::string& skill_id)
+{
+    // 倒着找，第一个不是数字的。前面就是技能基础id名字，后面的数字就是技能等级
+    for (size_t pos = skill_id.size(); pos != 0; --pos) {
+        if (!std::isdigit(static_cast<unsigned char>(skill_id[pos - 1]))) {
+            return skill_id.substr(0, pos);
+        }
+    }
+    return {};
+}
+
+cv::Mat asst::InfrastSkillIndex::calc_feature(const cv::Mat& icon)
+{
+    cv::Mat feature = cv::Mat::zeros(1, FeatureSide * FeatureSide, CV_32F);
+    if (icon.empty()) {
+        return feature;
+    }
+
+    cv::Mat gray;
+    if (icon.channels() == 3) {
+        cv::cvtColor(icon, gray, cv::COLOR_BGR2GRAY);
+    }
+    else {
+        gray = icon;
+    }
+    // 和 skill_analyze 一样只看中间的圆，模板圆外面本来就是黑的
+    cv::Mat mask(gray.size(), CV_8UC1, cv::Scalar(0));
+    cv::circle(mask, cv::Point(gray.cols / 2, gray.rows / 2), std::min(gray.cols, gray.rows) / 2, cv::Scalar(255), -1);
+    cv::Mat masked = cv::Mat::zeros(gray.size(), gray.type());
+    gray.copyTo(masked, mask);
+
+    cv::Mat small;
+    cv::GaussianBlur(masked, masked, cv::Size(3, 3), 0);
+    cv::resize(masked, small, cv::Size(FeatureSide, FeatureSide), 0, 0, cv::INTER_AREA);
+    small.reshape(1, 1).convertTo(feature, CV_32F);
+
+    // 去均值再归一化，两个特征的点积就是相关系数，不受整体亮度影响
+    feature.convertTo(feature, CV_32F, 1, -cv::mean(feature)[0]);
+    if (double norm = cv::norm(feature); norm > 1e-6) {
+        feature.convertTo(feature, CV_32F, 1 / norm);
+    }
+    return feature;
+}
+
+const asst::InfrastSkillIndex::FacilityFeatures& asst::InfrastSkillIndex::features(const std::string& facility)
+{
+    const auto& skills = InfrastData.get_skills(facility);
+    std::vector<std::string> skill_ids;
+    std::vector<const uchar*> templ_data;
+    skill_ids.reserve(skills.size());
+    templ_data.reserve(skills.size());
+    for (const auto& [id, skill] : skills) {
+        skill_ids.emplace_back(id);
+        templ_data.emplace_back(TemplResource::get_instance().get_templ(skill.templ_name).data);
+    }
+
+    auto& cached = m_features[facility];
+    if (cached.skill_ids == skill_ids && cached.templ_data == templ_data) {
+        return cached;
+    }
+
+    Log.info(__FUNCTION__, "| build skill features of", facility, skill_ids.size());
+    cached.features = cv::Mat::zeros(static_cast<int>(skill_ids.size()), FeatureSide * FeatureSide, CV_32F);
+    cached.base_ids.clear();
+    for (size_t i = 0; i < skill_ids.size(); ++i) {
+        const auto& templ = TemplResource::get_instance().get_templ(skills.at(skill_ids[i]).templ_name);
+        calc_feature(templ).copyTo(cached.features.row(static_cast<int>(i)));
+        cached.base_ids.emplace_back(base_id(skill_ids[i]));
+    }
+    cached.skill_ids = std::move(skill_ids);
+    cached.templ_data = std::move(templ_data);
+    return cached;
+}
+
+std::vector<std::vector<std::string>>
+    asst::InfrastSkillIndex::shortlist(const std::string& facility, const std::vector<cv::Mat>& icons, size_t top_k)
+{
+    std::vector<std::vector<std::string>> result(icons.size());
+    if (icons.empty()) {
+        return result;
+    }
+
+    cv::Mat queries(static_cast<int>(icons.size()), FeatureSide * FeatureSide, CV_32F);
+    for (size_t i = 0; i < icons.size(); ++i) {
+        calc_feature(icons[i]).copyTo(queries.row(static_cast<int>(i)));
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    const auto& facility_features = features(facility);
+    if (facility_features.skill_ids.empty()) {
+        return result;
+    }
+
+    // 所有图标和所有技能的相似度，一次矩阵乘法算完
+    cv::Mat similarity;
+    cv::gemm(queries, facility_features.features, 1, cv::Mat(), 0, similarity, cv::GEMM_2_T);
+
+    std::vector<std::pair<float, size_t>> scores(facility_features.skill_ids.size());
+    for (size_t i = 0; i < icons.size(); ++i) {
+        const float* row = similarity.ptr<float>(static_cast<int>(i));
+        for (size_t j = 0; j < scores.size(); ++j) {
+            scores[j] = { row[j], j };
+        }
+        ranges::sort(scores, std::greater {});
+        if (scores.front().first < MinSimilarity) {
+            Log.trace(__FUNCTION__, "| low similarity", scores.front().first);
+            continue;
+        }
+
+        // 同一种技能的不同等级长得很像，要一起交给模板匹配去区分
+        std::unordered_set<std::string> bases;
+        float last_base_score = scores.front().first; // 候选里最后一种技能的最高相似度
+        float next_base_score = -1.F;                 // 候选外最像的一种技能的相似度
+        for (const auto& [score, index] : scores) {
+            const auto& base = facility_features.base_ids[index];
+            if (bases.contains(base)) {
+                continue;
+            }
+            if (bases.size() >= top_k) {
+                next_base_score = score;
+                break;
+            }
+            bases.emplace(base);
+            last_base_score = score;
+        }
+        if (last_base_score - next_base_score < MinSimilarityMargin) {
+            Log.trace(__FUNCTION__, "| low similarity margin", last_base_score, next_base_score);
+            continue;
+        }
+        for (const auto& [score, index] : scores) {
+            if (bases.contains(facility_features.base_ids[index])) {
+                result[i].emplace_back(facility_features.skill_ids[index]);
+            }
+        }
+    }
+    return result;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Utils/NoWarningCVMat.h"
+#include "Utils/SingletonHolder.hpp"
+
+namespace asst
+{
+// 基建技能图标的特征索引，在模板匹配之前一次性给所有技能图标粗筛出最像的几个技能
+// 特征是圆形遮罩后缩小的灰度图，按需从 TemplResource 中的技能模板计算并缓存
+class InfrastSkillIndex final : public SingletonHolder<InfrastSkillIndex>
+{
+public:
+    virtual ~InfrastSkillIndex() override = default;
+
+    // 对 icons 中的每个技能图标，挑出该设施中最像的 top_k 种技能，连同它们其他等级的技能 id 一起返回
+    // 最像的也不够像、或者候选内外的技能相似度拉不开差距时返回空的，需要调用方全部匹配一遍
+    std::vector<std::vector<std::string>>
+        shortlist(const std::string& facility, const std::vector<cv::Mat>& icons, size_t top_k);
+
+    // 技能 id 去掉末尾表示等级的数字，例如 bskill_man_exp1 和 bskill_man_exp2 都是 bskill_man_exp
+    static std::string base_id(const std::string& skill_id);
+
+private:
+    friend class SingletonHolder<InfrastSkillIndex>;
+
+    InfrastSkillIndex() = default;
+
+    struct FacilityFeatures
+    {
+        std::vector<std::string> skill_ids;
+        std::vector<std::string> base_ids;
+        std::vector<const uchar*> templ_data; // 模板重新加载后数据指针会变，据此判断是否需要重新计算
+        cv::Mat features;                     // 每行一个技能
+    };
+
+    static cv::Mat calc_feature(const cv::Mat& icon);
+    const FacilityFeatures& features(const std::string& facility);
+
+    std::mutex m_mutex;
+    std::unordered_map<std::string, FacilityFeatures> m_features;
+};
+} // namespace asst
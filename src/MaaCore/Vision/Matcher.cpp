@@ -11,6 +11,7 @@ using namespace asst;
 
 Matcher::ResultOpt Matcher::analyze() const
 {
+    ProfileScope("Matcher::analyze", "vision");
     const auto match_results = preproc_and_match(make_roi(m_image, m_roi), m_params);
 
     for (size_t i = 0; i < match_results.size(); ++i) {
@@ -30,10 +31,10 @@ Matcher::ResultOpt Matcher::analyze() const
 
         double threshold = m_params.templ_thres[i];
         if (m_log_tracing && max_val > 0.5 && max_val > threshold - 0.2) { // 得分太低的肯定不对，没必要打印
-            Log.trace("match_templ |", templ_name, "score:", max_val, "rect:", rect, "roi:", m_roi);
+            LogTraceLazy("match_templ |", templ_name, "score:", max_val, "rect:", rect, "roi:", m_roi);
         }
         else {
-            Log.debug("match_templ |", templ_name, "score:", max_val, "rect:", rect, "roi:", m_roi);
+            LogDebugLazy("match_templ |", templ_name, "score:", max_val, "rect:", rect, "roi:", m_roi);
         }
         if (max_val < threshold) {
             continue;
@@ -6,10 +6,15 @@
 #include "Config/TaskData.h"
 #include "Config/TemplResource.h"
 #include "Utils/Logger.hpp"
+#include "Utils/Ranges.hpp"
 #include "Vision/Matcher.h"
-#include "Vision/RegionOCRer.h"
+#include "Vision/DigitOCRer.h"
+#include "ItemFeatureIndex.h"
 
+#include <future>
 #include <numbers>
+#include <numeric>
+#include <thread>
 
 bool asst::DepotImageAnalyzer::analyze()
 {
@@ -126,12 +131,40 @@ bool asst::DepotImageAnalyzer::analyze_all_items()
 {
     LogTraceFunction;
 
+    std::vector<Rect> item_rois;
     for (const Rect& roi : m_all_items_roi) {
-        if (check_roi_empty(roi)) { // roi 是竖着有序的
-            break;
+        // 空格子只会在最后，但误判的代价是丢掉后面所有格子，所以只跳过这一个
+        if (check_roi_empty(roi)) {
+            continue;
+        }
+        item_rois.emplace_back(roi);
+    }
+
+    std::vector<ItemInfo> infos(item_rois.size());
+    std::vector<size_t> positions(item_rois.size(), NPos);
+    // 各个格子先不管前后顺序，只在粗筛出来的候选里并行匹配一遍
+    const size_t thread_count = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, 8);
+    std::vector<std::future<void>> futures;
+    for (size_t t = 0; t < thread_count; ++t) {
+        futures.emplace_back(std::async(std::launch::async, [&, t]() {
+            for (size_t i = t; i < item_rois.size(); i += thread_count) {
+                positions[i] = match_item(item_rois[i], infos[i], m_match_begin_pos, true, false);
+            }
+        }));
+    }
+    for (auto& future : futures) {
+        future.get();
+    }
+
+    for (size_t i = 0; i < item_rois.size(); ++i) {
+        const Rect& roi = item_rois[i];
+        ItemInfo& info = infos[i];
+        size_t cur_pos = positions[i];
+        // 材料是按顺序排列的，并行的结果没匹配上或者排在前一个之前的，再按原来的方式从前一个之后挨个匹配
+        if (cur_pos == NPos || cur_pos < m_match_begin_pos) {
+            info = ItemInfo {};
+            cur_pos = match_item(roi, info, m_match_begin_pos);
         }
-        ItemInfo info;
-        size_t cur_pos = match_item(roi, info, m_match_begin_pos);
         if (cur_pos == NPos) {
             break;
         }
@@ -175,16 +208,34 @@ bool asst::DepotImageAnalyzer::analyze_all_items()
 
 bool asst::DepotImageAnalyzer::check_roi_empty(const Rect& roi)
 {
-    // TODO
-    std::ignore = roi;
-    return false;
+    // 空格子只有背景，整个格子几乎是纯色的
+    // 有材料的格子即使图标本身纹理很少，也还有边框、右下角的数量等，整个格子不会是纯色
+    // 阈值没有用实际的截图校准过，宁可判成非空：非空的格子只是多匹配一次，匹配不上照样会停下来
+    const cv::Rect rect = make_rect<cv::Rect>(roi) & cv::Rect(0, 0, m_image_resized.cols, m_image_resized.rows);
+    if (rect.empty()) {
+        return true;
+    }
+
+    cv::Mat gray;
+    cv::cvtColor(m_image_resized(rect), gray, cv::COLOR_BGR2GRAY);
+    cv::Scalar mean;
+    cv::Scalar stddev;
+    cv::meanStdDev(gray, mean, stddev);
+
+    constexpr double EmptyStddevThreshold = 4.0;
+    bool empty = stddev[0] < EmptyStddevThreshold;
+    if (empty) {
+        Log.info(__FUNCTION__, "empty roi", roi, "stddev", stddev[0]);
+    }
+    return empty;
 }
 
 size_t asst::DepotImageAnalyzer::match_item(
     const Rect& roi,
     /* out */ ItemInfo& item_info,
     size_t begin_index,
-    bool with_enlarge)
+    bool with_enlarge,
+    bool with_full_scan)
 {
     LogTraceFunction;
 
@@ -199,29 +250,61 @@ size_t asst::DepotImageAnalyzer::match_item(
     }
     analyzer.set_roi(enlarged_roi);
 
+    // 匹配到了任一结果后，再往后匹配几个。
+    // 因为有些相邻的材料长得很像（同一种类的）
+    constexpr size_t MaxExtraMatch = 8;
+
     MatchRect matched;
     std::string matched_item_id;
     size_t matched_index = NPos;
-    for (size_t index = begin_index, extra_count = 0; index < all_items.size(); ++index) {
-        const std::string& item_id = all_items.at(index);
-        // analyzer.set_templ(item_id);
-        // TODO: too slow? find a way to set mask directly
-        cv::Mat templ = TemplResource::get_instance().get_templ(item_id).clone();
-        templ(cv::Rect { templ.cols - 80, templ.rows - 50, 80, 50 }) = cv::Scalar { 0, 0, 0 };
-        analyzer.set_templ(templ);
-        if (!analyzer.analyze()) {
-            continue;
+    auto match_in_order = [&](const std::vector<size_t>& indices) {
+        for (size_t extra_count = 0; size_t index : indices) {
+            const std::string& item_id = all_items.at(index);
+            // 数量区域已经涂黑了，缓存着的模板不用每次都拷贝一份
+            analyzer.set_templ(ItemFeatureIndex::get_instance().masked_templ(item_id));
+            if (!analyzer.analyze()) {
+                continue;
+            }
+            if (double score = analyzer.get_result().score; score >= matched.score) {
+                matched = analyzer.get_result();
+                matched_item_id = item_id;
+                matched_index = index;
+            }
+            if (matched_index != NPos && ++extra_count >= MaxExtraMatch) {
+                break;
+            }
         }
-        if (double score = analyzer.get_result().score; score >= matched.score) {
-            matched = analyzer.get_result();
-            matched_item_id = item_id;
-            matched_index = index;
+    };
+
+    // 先按颜色特征挑出最像的一些，仍然按原来的顺序匹配
+    constexpr size_t ShortlistSize = 16;
+    auto shortlist =
+        ItemFeatureIndex::get_instance().shortlist(m_image_resized, roi, all_items, ShortlistSize, begin_index);
+    ranges::sort(shortlist);
+    match_in_order(shortlist);
+
+    // 真正的材料可能没进候选，而同一类的另一个进了、也匹配得上
+    // 所以还要和前后同类的材料都比一下，并且分数足够高才采信，否则按原来的方式挨个试一遍
+    constexpr double ShortlistConfidentScore = 0.9;
+    if (matched_index != NPos) {
+        std::vector<size_t> neighbours;
+        const size_t first = std::max(begin_index, matched_index - std::min(matched_index, MaxExtraMatch));
+        const size_t last = std::min(all_items.size(), matched_index + MaxExtraMatch + 1);
+        for (size_t index = first; index < last; ++index) {
+            if (!ranges::binary_search(shortlist, index)) {
+                neighbours.emplace_back(index);
+            }
         }
-        // 匹配到了任一结果后，再往后匹配几个。
-        // 因为有些相邻的材料长得很像（同一种类的）
-        constexpr size_t MaxExtraMatch = 8;
-        if (matched_index != NPos && ++extra_count >= MaxExtraMatch) {
-            break;
+        match_in_order(neighbours);
+    }
+    if (matched_index == NPos || matched.score < ShortlistConfidentScore) {
+        matched = MatchRect();
+        matched_item_id.clear();
+        matched_index = NPos;
+        if (with_full_scan) {
+            std::vector<size_t> all_indices(all_items.size() - std::min(begin_index, all_items.size()));
+            std::iota(all_indices.begin(), all_indices.end(), begin_index);
+            match_in_order(all_indices);
         }
     }
     Log.info("Item id:", matched_item_id);
@@ -279,16 +362,18 @@ int asst::DepotImageAnalyzer::match_quantity(const ItemInfo& item)
         item_templ * 0.41,
         ocr_img(make_rect<cv::Rect>(item.rect)));
 
-    RegionOCRer analyzer(m_image_resized);
+    DigitOCRer analyzer(m_image_resized);
     analyzer.set_task_info("NumberOcrReplace");
     analyzer.set_roi(ocr_roi);
     analyzer.set_bin_threshold(task_ptr->special_params[0], task_ptr->special_params[1]);
+    analyzer.set_glyph_set("DepotQuantity");
 
-    if (!analyzer.analyze()) {
+    auto result_opt = analyzer.analyze();
+    if (!result_opt) {
         return 0;
     }
 
-    const auto& result = analyzer.get_result();
+    const auto& result = *result_opt;
 
 #ifdef ASST_DEBUG
     cv::rectangle(m_image_draw_resized, make_rect<cv::Rect>(result.rect), cv::Scalar(0, 0, 255));
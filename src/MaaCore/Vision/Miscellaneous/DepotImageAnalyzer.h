@@ -33,8 +33,13 @@ private:
     bool analyze_all_items();
 
     bool check_roi_empty(const Rect& roi);
-    size_t
-        match_item(const Rect& roi, /* out */ ItemInfo& item_info, size_t begin_index = 0ULL, bool with_enlarge = true);
+    // with_full_scan 为 false 时只在颜色粗筛出来的候选里找，找不到或者不够确定就返回 NPos
+    size_t match_item(
+        const Rect& roi,
+        /* out */ ItemInfo& item_info,
+        size_t begin_index = 0ULL,
+        bool with_enlarge = true,
+        bool with_full_scan = true);
     int match_quantity(const ItemInfo& item);
     Rect resize_rect_to_raw_size(const Rect& rect);
 
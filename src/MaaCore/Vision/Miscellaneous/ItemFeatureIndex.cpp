@@ -0,0 +1,114 @@
+#include "ItemFeatureIndex.h"
+
+#include "Utils/NoWarningCV.h"
+
+#include "Config/TemplResource.h"
+#include "Utils/Ranges.hpp"
+
+namespace
+{
+// 中心正方形的边长占图标短边的比例
+constexpr double CenterRatio = 0.5;
+
+// 右下角数量区域的大小
+constexpr int QuantityWidth = 80;
+constexpr int QuantityHeight = 50;
+
+cv::Rect center_square(const cv::Rect& rect)
+{
+    const int side = std::max(static_cast<int>(std::min(rect.width, rect.height) * CenterRatio), 1);
+    return { rect.x + (rect.width - side) / 2, rect.y + (rect.height - side) / 2, side, side };
+}
+}
+
+cv::Mat asst::ItemFeatureIndex::calc_hist(const cv::Mat& image, const cv::Rect& rect)
+{
+    const cv::Rect center = center_square(rect) & cv::Rect(0, 0, image.cols, image.rows);
+    if (center.empty()) {
+        return {};
+    }
+
+    cv::Mat hsv;
+    cv::cvtColor(image(center), hsv, cv::COLOR_BGR2HSV);
+    // 模板的背景是纯黑的，不参与统计
+    cv::Mat mask;
+    cv::inRange(hsv, cv::Scalar { 0, 0, 16 }, cv::Scalar { 180, 255, 255 }, mask);
+
+    static constexpr int Channels[] = { 0, 1 };
+    static constexpr int HistSize[] = { 18, 4 };
+    static constexpr float HueRange[] = { 0, 180 };
+    static constexpr float SatRange[] = { 0, 256 };
+    static const float* Ranges[] = { HueRange, SatRange };
+
+    cv::Mat hist;
+    cv::calcHist(&hsv, 1, Channels, mask, hist, 2, HistSize, Ranges);
+    cv::normalize(hist, hist, 1, 0, cv::NORM_L1);
+    return hist;
+}
+
+const cv::Mat& asst::ItemFeatureIndex::feature(const std::string& item_id)
+{
+    const cv::Mat& templ = TemplResource::get_instance().get_templ(item_id);
+    auto& feature = m_features[item_id];
+    if (feature.templ_data != templ.data) {
+        feature.templ_data = templ.data;
+        feature.hist = templ.empty() ? cv::Mat() : calc_hist(templ, cv::Rect(0, 0, templ.cols, templ.rows));
+    }
+    return feature.hist;
+}
+
+std::vector<size_t> asst::ItemFeatureIndex::shortlist(
+    const cv::Mat& image,
+    const Rect& roi,
+    const std::vector<std::string>& candidates,
+    size_t top_k,
+    size_t begin)
+{
+    const cv::Mat query = calc_hist(image, make_rect<cv::Rect>(roi));
+    if (query.empty() || begin >= candidates.size()) {
+        return {};
+    }
+
+    std::vector<std::pair<double, size_t>> scores;
+    scores.reserve(candidates.size() - begin);
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (size_t i = begin; i < candidates.size(); ++i) {
+            const cv::Mat& hist = feature(candidates[i]);
+            if (hist.empty()) {
+                continue;
+            }
+            // 直方图交集，两个都归一化过，越大越像
+            scores.emplace_back(cv::compareHist(query, hist, cv::HISTCMP_INTERSECT), i);
+        }
+    }
+
+    const size_t count = std::min(top_k, scores.size());
+    ranges::partial_sort(scores, scores.begin() + count, std::greater {});
+    std::vector<size_t> result;
+    result.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        result.emplace_back(scores[i].second);
+    }
+    return result;
+}
+
+cv::Mat asst::ItemFeatureIndex::masked_templ(const std::string& item_id)
+{
+    // 模板是懒加载的，get_templ 也得放在锁里
+    std::unique_lock<std::mutex> lock(m_mutex);
+    const cv::Mat& templ = TemplResource::get_instance().get_templ(item_id);
+    auto& masked = m_masked_templs[item_id];
+    if (masked.templ_data != templ.data) {
+        masked.templ_data = templ.data;
+        // 图集里的模板是只读映射的，得拷一份再改
+        masked.templ = templ.clone();
+        const cv::Rect quantity_rect =
+            cv::Rect(templ.cols - QuantityWidth, templ.rows - QuantityHeight, QuantityWidth, QuantityHeight) &
+            cv::Rect(0, 0, templ.cols, templ.rows);
+        if (!quantity_rect.empty()) {
+            masked.templ(quantity_rect) = cv::Scalar { 0, 0, 0 };
+        }
+    }
+    return masked.templ;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Common/AsstTypes.h"
+#include "Utils/NoWarningCVMat.h"
+#include "Utils/SingletonHolder.hpp"
+
+namespace asst
+{
+// 材料图标的颜色特征索引，用来在模板匹配之前先粗筛出最像的几个候选
+// 特征是图标中心区域的 HSV 直方图，按需从 TemplResource 中的模板计算并缓存
+// 顺带缓存涂掉了数量区域的模板，供仓库识别直接拿去匹配
+class ItemFeatureIndex final : public SingletonHolder<ItemFeatureIndex>
+{
+public:
+    virtual ~ItemFeatureIndex() override = default;
+
+    // 从 candidates[begin, end) 中挑出和 image(roi) 颜色分布最像的 top_k 个，
+    // 返回的是在 candidates 中的下标，按相似度从高到低排列
+    std::vector<size_t> shortlist(
+        const cv::Mat& image,
+        const Rect& roi,
+        const std::vector<std::string>& candidates,
+        size_t top_k,
+        size_t begin = 0);
+
+    // 右下角数量区域涂黑之后的模板，只在第一次用到时生成一次
+    // 返回的是共享数据的 cv::Mat，不要写入
+    cv::Mat masked_templ(const std::string& item_id);
+
+private:
+    friend class SingletonHolder<ItemFeatureIndex>;
+
+    ItemFeatureIndex() = default;
+
+    struct Feature
+    {
+        const uchar* templ_data = nullptr; // 模板重新加载后数据指针会变，据此判断是否需要重新计算
+        cv::Mat hist;
+    };
+
+    struct MaskedTempl
+    {
+        const uchar* templ_data = nullptr;
+        cv::Mat templ;
+    };
+
+    // 取中心一块正方形区域的直方图，避开边缘的背景和右下角的数量
+    static cv::Mat calc_hist(const cv::Mat& image, const cv::Rect& rect);
+    const cv::Mat& feature(const std::string& item_id);
+
+    std::mutex m_mutex;
+    std::unordered_map<std::string, Feature> m_features;
+    std::unordered_map<std::string, MaskedTempl> m_masked_templs;
+};
+} // namespace asst
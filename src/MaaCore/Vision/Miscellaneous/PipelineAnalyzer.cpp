@@ -5,6 +5,7 @@
 
 #include "Config/TaskData.h"
 #include "Status.h"
+#include "TaskMetrics.h"
 #include "Utils/Logger.hpp"
 #include "Vision/Matcher.h"
 #include "Vision/OCRer.h"
@@ -12,10 +13,12 @@
 
 using namespace asst;
 
-PipelineAnalyzer::ResultOpt PipelineAnalyzer::analyze() const
+std::vector<std::shared_ptr<TaskInfo>> PipelineAnalyzer::resolve_tasks(const std::vector<std::string>& tasks_name)
 {
-    for (const std::string& task_name : m_tasks_name) {
-        const auto& task_ptr = Task.get(task_name);
+    std::vector<std::shared_ptr<TaskInfo>> tasks;
+    tasks.reserve(tasks_name.size());
+    for (const std::string& task_name : tasks_name) {
+        auto task_ptr = Task.get(task_name);
         // 可能有配置错误，导致不存在对应的任务
         if (task_ptr == nullptr) {
             Log.error("Invalid task", task_name);
@@ -24,25 +27,37 @@ PipelineAnalyzer::ResultOpt PipelineAnalyzer::analyze() const
 #endif
             continue;
         }
+        tasks.emplace_back(std::move(task_ptr));
+    }
+    return tasks;
+}
 
+PipelineAnalyzer::ResultOpt PipelineAnalyzer::analyze() const
+{
+    for (const auto& task_ptr : m_tasks) {
         // Log.trace(__FUNCTION__, task_ptr->name);
+        MetricsTimer timer;
         switch (task_ptr->algorithm) {
         case AlgorithmType::JustReturn: {
             return Result { .task_ptr = task_ptr };
         } break;
 
-        case AlgorithmType::MatchTemplate:
-            if (auto match_opt = match(task_ptr)) {
+        case AlgorithmType::MatchTemplate: {
+            auto match_opt = match(task_ptr);
+            record_metrics(task_ptr, timer.elapsed(), match_opt.has_value());
+            if (match_opt) {
                 Log.trace(__FUNCTION__, "| MatchTemplate", task_ptr->name);
                 return Result { .task_ptr = task_ptr, .result = *match_opt, .rect = match_opt->rect };
             }
-            break;
-        case AlgorithmType::OcrDetect:
-            if (auto ocr_opt = ocr(task_ptr)) {
+        } break;
+        case AlgorithmType::OcrDetect: {
+            auto ocr_opt = ocr(task_ptr);
+            record_metrics(task_ptr, timer.elapsed(), ocr_opt.has_value());
+            if (ocr_opt) {
                 Log.trace(__FUNCTION__, "| OcrDetect", task_ptr->name, *ocr_opt);
                 return Result { .task_ptr = task_ptr, .result = ocr_opt->front(), .rect = ocr_opt->front().rect };
             }
-            break;
+        } break;
         default:
             break;
         }
@@ -50,16 +65,27 @@ PipelineAnalyzer::ResultOpt PipelineAnalyzer::analyze() const
     return std::nullopt;
 }
 
+void PipelineAnalyzer::record_metrics(
+    const std::shared_ptr<TaskInfo>& task_ptr,
+    std::chrono::steady_clock::duration elapsed,
+    bool hit) const
+{
+    if (auto metrics_ptr = metrics()) {
+        metrics_ptr->add_recognition(task_ptr->name, task_ptr->algorithm, elapsed, hit);
+    }
+}
+
 Matcher::ResultOpt PipelineAnalyzer::match(const std::shared_ptr<TaskInfo>& task_ptr) const
 {
     Matcher match_analyzer(m_image, m_roi);
 
-    const auto match_task_ptr = std::dynamic_pointer_cast<MatchTaskInfo>(task_ptr);
+    // TaskData 按 algorithm 生成对应类型的任务，不需要 dynamic_cast
+    const auto match_task_ptr = std::static_pointer_cast<MatchTaskInfo>(task_ptr);
     if (ranges::all_of(match_task_ptr->templ_thresholds, [](double t) { return t > 1.0; })) {
         Log.info(match_task_ptr->name, "'s threshold is", match_task_ptr->templ_thresholds, ", just skip");
         return std::nullopt;
     }
-    match_analyzer.set_task_info(match_task_ptr);
+    match_analyzer.set_task_info(*match_task_ptr);
 
     bool use_cache = m_inst && match_task_ptr->cache;
     if (use_cache) {
@@ -83,7 +109,7 @@ Matcher::ResultOpt PipelineAnalyzer::match(const std::shared_ptr<TaskInfo>& task
 
 OCRer::ResultsVecOpt PipelineAnalyzer::ocr(const std::shared_ptr<TaskInfo>& task_ptr) const
 {
-    const auto ocr_task_ptr = std::dynamic_pointer_cast<OcrTaskInfo>(task_ptr);
+    const auto ocr_task_ptr = std::static_pointer_cast<OcrTaskInfo>(task_ptr);
 
     bool det = !ocr_task_ptr->without_det;
     bool use_cache = m_inst && ocr_task_ptr->cache;
@@ -97,7 +123,7 @@ OCRer::ResultsVecOpt PipelineAnalyzer::ocr(const std::shared_ptr<TaskInfo>& task
 
     if (det) {
         OCRer analyzer(m_image, m_roi);
-        analyzer.set_task_info(ocr_task_ptr);
+        analyzer.set_task_info(*ocr_task_ptr);
         if (use_cache && cache_opt) {
             analyzer.set_roi(*cache_opt);
             analyzer.set_without_det(true);
@@ -110,7 +136,7 @@ OCRer::ResultsVecOpt PipelineAnalyzer::ocr(const std::shared_ptr<TaskInfo>& task
     }
     else {
         RegionOCRer analyzer(m_image, m_roi);
-        analyzer.set_task_info(ocr_task_ptr);
+        analyzer.set_task_info(*ocr_task_ptr);
         if (use_cache && cache_opt) {
             analyzer.set_roi(*cache_opt);
         }
@@ -1,6 +1,7 @@
 #pragma once
 #include "Vision/VisionHelper.h"
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <vector>
@@ -28,14 +29,22 @@ public:
     using VisionHelper::VisionHelper;
     virtual ~PipelineAnalyzer() override = default;
 
-    void set_tasks(std::vector<std::string> tasks_name) { m_tasks_name = std::move(tasks_name); }
+    void set_tasks(const std::vector<std::string>& tasks_name) { m_tasks = resolve_tasks(tasks_name); }
+    void set_tasks(std::vector<std::shared_ptr<TaskInfo>> tasks) { m_tasks = std::move(tasks); }
+
+    // 按任务名取出任务，不存在的任务会被跳过。重复识别同一个列表时可以只取一次
+    static std::vector<std::shared_ptr<TaskInfo>> resolve_tasks(const std::vector<std::string>& tasks_name);
 
     ResultOpt analyze() const;
 
 private:
     Matcher::ResultOpt match(const std::shared_ptr<TaskInfo>& task_ptr) const;
     OCRer::ResultsVecOpt ocr(const std::shared_ptr<TaskInfo>& task_ptr) const;
+    void record_metrics(
+        const std::shared_ptr<TaskInfo>& task_ptr,
+        std::chrono::steady_clock::duration elapsed,
+        bool hit) const;
 
-    std::vector<std::string> m_tasks_name;
+    std::vector<std::shared_ptr<TaskInfo>> m_tasks;
 };
 }
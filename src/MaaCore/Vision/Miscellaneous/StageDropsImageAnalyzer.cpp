@@ -13,9 +13,11 @@
 #include "Config/TemplResource.h"
 #include "Utils/ImageIo.hpp"
 #include "Utils/Logger.hpp"
+#include "Vision/DigitOCRer.h"
 #include "Vision/Matcher.h"
 #include "Vision/RegionOCRer.h"
 #include "Vision/TemplDetOCRer.h"
+#include "ItemFeatureIndex.h"
 
 bool asst::StageDropsImageAnalyzer::analyze()
 {
@@ -658,13 +660,14 @@ std::string asst::StageDropsImageAnalyzer::match_item(const Rect& roi, StageDrop
         break;
     }
 
+    double max_score = 0.0;
     auto match_item_with_templs = [&](const std::vector<std::string>& templs_list) -> std::string {
         Matcher analyzer(m_image);
         analyzer.set_mask_ranges({}, false, true);
         analyzer.set_task_info("StageDrops-Item");
         analyzer.set_roi(roi);
 
-        double max_score = 0.0;
+        max_score = 0.0;
         std::string matched;
         for (const std::string& templ : templs_list) {
             analyzer.set_templ(templ);
@@ -688,9 +691,21 @@ std::string asst::StageDropsImageAnalyzer::match_item(const Rect& roi, StageDrop
     }
 
     // 没识别到的话就把全部材料都拿来跑一遍
+    // 先按颜色特征挑出最像的几个来匹配。真正的材料可能没进候选，而长得像的进了、也匹配得上，
+    // 结果还会被记到该关卡的掉落里，所以分数不够高的话还是全部试一遍
     if (result.empty()) {
-        auto items = ItemData.get_all_item_id();
-        result = match_item_with_templs(std::vector<std::string>(items.cbegin(), items.cend()));
+        const auto& items = ItemData.get_all_item_id();
+        std::vector<std::string> all_items(items.cbegin(), items.cend());
+        constexpr size_t ShortlistSize = 10;
+        std::vector<std::string> shortlist;
+        for (size_t index : ItemFeatureIndex::get_instance().shortlist(m_image, roi, all_items, ShortlistSize)) {
+            shortlist.emplace_back(all_items[index]);
+        }
+        constexpr double ShortlistConfidentScore = 0.9;
+        result = match_item_with_templs(shortlist);
+        if (result.empty() || max_score < ShortlistConfidentScore) {
+            result = match_item_with_templs(all_items);
+        }
         // 将这次识别到的加入该关卡的待识别列表
         if (!result.empty() && !m_stage_code.empty()) {
             StageDrops.append_drops(StageKey { m_stage_code, m_difficulty }, type, result);
@@ -838,18 +853,15 @@ std::optional<asst::TextRect> asst::StageDropsImageAnalyzer::match_quantity_stri
     cv::Mat ocr_img = m_image.clone();
     cv::subtract(ocr_img(make_rect<cv::Rect>(new_roi)), templ * 0.41, ocr_img(make_rect<cv::Rect>(new_roi)));
 
-    RegionOCRer ocr(ocr_img);
+    DigitOCRer ocr(ocr_img);
     ocr.set_task_info("NumberOcrReplace");
     Rect ocr_roi { new_roi.x + mask_rect.x, new_roi.y + mask_rect.y, mask_rect.width, mask_rect.height };
     ocr.set_roi(ocr_roi);
     ocr.set_use_char_model(!use_word_model);
     ocr.set_bin_threshold(color_scale.first, color_scale.second);
+    ocr.set_glyph_set("StageDropsQuantity");
 
-    if (!ocr.analyze()) {
-        return std::nullopt;
-    }
-
-    return ocr.get_result();
+    return ocr.analyze();
 }
 
 int asst::StageDropsImageAnalyzer::quantity_string_to_int(const std::string& str)
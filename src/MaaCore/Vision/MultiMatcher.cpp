@@ -14,6 +14,7 @@ using namespace asst;
 
 MultiMatcher::ResultsVecOpt MultiMatcher::analyze() const
 {
+    ProfileScope("MultiMatcher::analyze", "vision");
     auto match_results = Matcher::preproc_and_match(make_roi(m_image, m_roi), m_params);
 
     std::vector<Result> results;
@@ -79,7 +80,7 @@ MultiMatcher::ResultsVecOpt MultiMatcher::analyze() const
 #endif
 
     if (m_log_tracing) {
-        Log.trace("multi_match | ", "result:", results, "roi:", m_roi);
+        LogTraceLazy("multi_match | ", "result:", results, "roi:", m_roi);
     }
 
     // FIXME: 老接口太难重构了，先弄个这玩意兼容下，后续慢慢全删掉
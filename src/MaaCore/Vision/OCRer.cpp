@@ -7,11 +7,13 @@
 #include "Config/Miscellaneous/OcrPack.h"
 #include "Config/TaskData.h"
 #include "Utils/Logger.hpp"
+#include "Utils/StringMisc.hpp"
 
 using namespace asst;
 
 OCRer::ResultsVecOpt OCRer::analyze() const
 {
+    ProfileScope("OCRer::analyze", "vision");
     OcrPack* ocr_ptr = nullptr;
     if (m_params.use_char_model) {
         ocr_ptr = &CharOcr::get_instance();
@@ -44,7 +46,7 @@ OCRer::ResultsVecOpt OCRer::analyze() const
         return std::nullopt;
     }
 
-    Log.trace("Proceed", results_vec);
+    LogTraceLazy("Proceed", results_vec);
 
     m_result = std::move(results_vec);
     return m_result;
@@ -73,27 +75,46 @@ void OCRer::postproc_replace_(Result& res) const
     }
 
     for (const auto& [regex, new_str] : m_params.replace) {
+        // 纯字符串的规则不走 std::regex；new_str 里有 $ 时可能是 format 语法，还是交给 regex
+        if (regex->literal && new_str.find('$') == std::string::npos) {
+            if (res.text.find(*regex->literal) == std::string::npos) {
+                continue;
+            }
+            if (m_params.replace_full) {
+                res.text = new_str;
+            }
+            else {
+                utils::string_replace_all_in_place(res.text, *regex->literal, new_str);
+            }
+            continue;
+        }
+
         if (m_params.replace_full) {
-            if (std::regex_search(res.text, std::regex(regex))) {
+            if (std::regex_search(res.text, regex->regex)) {
                 res.text = new_str;
             }
         }
         else {
-            res.text = std::regex_replace(res.text, std::regex(regex), new_str);
+            res.text = std::regex_replace(res.text, regex->regex, new_str);
         }
     }
 }
 
 bool OCRer::filter_and_replace_by_required_(Result& res) const
 {
-    if (m_params.required.empty()) {
+    return filter_by_required(res, m_params);
+}
+
+bool OCRer::filter_by_required(Result& res, const Params& params)
+{
+    if (params.required.empty()) {
         return true;
     }
     auto& ocr_config = OcrConfig::get_instance();
     auto equ_text = ocr_config.process_equivalence_class(res.text);
 
-    if (m_params.full_match) {
-        auto required = m_params.required | views::transform([&](const auto& str) { return str.second; });
+    if (params.full_match) {
+        auto required = params.required | views::transform([&](const auto& str) { return str.second; });
         return ranges::find(required, equ_text) != required.end();
     }
     else {
@@ -104,6 +125,6 @@ bool OCRer::filter_and_replace_by_required_(Result& res) const
             res.text = p.first;
             return true;
         };
-        return ranges::find_if(m_params.required, is_sub) != m_params.required.cend();
+        return ranges::find_if(params.required, is_sub) != params.required.cend();
     };
 }
@@ -23,6 +23,9 @@ public:
     // FIXME: 老接口太难重构了，先弄个这玩意兼容下，后续慢慢全删掉
     const auto& get_result() const noexcept { return m_result; }
 
+    // 按 params.required 过滤，非全匹配时会把 res.text 替换成匹配上的 required；不经过 OcrPack 的结果也要走一遍
+    static bool filter_by_required(Result& res, const Params& params);
+
 protected:
     virtual void _set_roi(const Rect& roi) override { set_roi(roi); }
 
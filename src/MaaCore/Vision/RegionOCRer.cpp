@@ -2,10 +2,13 @@
 
 #include "Utils/NoWarningCV.h"
 
+#include "Utils/Profiler.hpp"
+
 using namespace asst;
 
 RegionOCRer::ResultOpt RegionOCRer::analyze() const
 {
+    ProfileScope("RegionOCRer::analyze", "vision");
     cv::Mat img_roi = make_roi(m_image, m_roi);
     cv::Mat img_roi_gray;
     cv::cvtColor(img_roi, img_roi_gray, cv::COLOR_BGR2GRAY);
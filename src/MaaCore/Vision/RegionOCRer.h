@@ -13,7 +13,7 @@ public:
     using VisionHelper::VisionHelper;
     virtual ~RegionOCRer() override = default;
 
-    ResultOpt analyze() const;
+    virtual ResultOpt analyze() const;
 
     void set_use_raw(bool use_raw) { m_use_raw = use_raw; }
 
@@ -28,9 +28,10 @@ protected:
     void bin_left_trim(cv::Mat& bin) const;
     void bin_right_trim(cv::Mat& bin) const;
 
-private:
     // FIXME: 老接口太难重构了，先弄个这玩意兼容下，后续慢慢全删掉
     mutable Result m_result;
+
+private:
     bool m_use_raw = true;
 };
 }
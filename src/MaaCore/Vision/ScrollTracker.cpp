@@ -0,0 +1,59 @@
+#include "ScrollTracker.h"
+
+#include "Utils/Logger.hpp"
+#include "Vision/Matcher.h"
+
+std::optional<int> asst::ScrollTracker::update(const cv::Mat& image)
+{
+    m_offset = m_prev_image.empty() ? std::nullopt : estimate(image);
+    m_prev_image = image;
+    return m_offset;
+}
+
+void asst::ScrollTracker::reset() noexcept
+{
+    m_prev_image = cv::Mat();
+    m_offset = std::nullopt;
+}
+
+std::optional<asst::Rect> asst::ScrollTracker::from_previous(const Rect& rect) const noexcept
+{
+    if (!m_offset) {
+        return std::nullopt;
+    }
+    Rect moved = rect;
+    moved.x += *m_offset;
+    return moved;
+}
+
+std::optional<int> asst::ScrollTracker::estimate(const cv::Mat& image) const
+{
+    // 同 StageDropsImageAnalyzer::merge_image，取上一张图列表右边的一段，在新图里找它滑到了哪里
+    // 一次滑动超过四分之三页的话就找不到了，这时候也没有多少可以复用的
+    constexpr int RefRatio = 4;
+    constexpr double Threshold = 0.8;
+    // 列表是横向滑动的，纵向差太多说明匹配错了
+    constexpr int MaxVerticalDiff = 5;
+
+    Rect ref_rect = m_roi;
+    ref_rect.width = m_roi.width / RefRatio;
+    ref_rect.x = m_roi.x + m_roi.width - ref_rect.width;
+
+    Matcher offset_match(image);
+    offset_match.set_roi(m_roi);
+    offset_match.set_templ(m_prev_image(make_rect<cv::Rect>(ref_rect)));
+    offset_match.set_threshold(Threshold);
+    offset_match.set_method(MatchMethod::Ccoeff);
+    if (!offset_match.analyze()) {
+        Log.info(__FUNCTION__, "| no overlap with the previous image");
+        return std::nullopt;
+    }
+    const Rect& matched = offset_match.get_result().rect;
+    if (std::abs(matched.y - ref_rect.y) > MaxVerticalDiff) {
+        Log.warn(__FUNCTION__, "| vertical diff too large", matched.y - ref_rect.y);
+        return std::nullopt;
+    }
+    const int offset = matched.x - ref_rect.x;
+    Log.info(__FUNCTION__, "| offset", offset, "score", offset_match.get_result().score);
+    return offset;
+}
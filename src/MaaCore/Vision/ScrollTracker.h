@@ -0,0 +1,37 @@
+#pragma once
+
+#include <optional>
+
+#include "Common/AsstTypes.h"
+#include "Utils/NoWarningCVMat.h"
+
+namespace asst
+{
+// 横向滑动列表的跟踪器，估计相邻两次截图之间列表滑动了多少
+// 上一张图里已经完整识别过的内容，可以直接把结果挪到新的位置，只识别新滑进来的部分
+class ScrollTracker
+{
+public:
+    // roi 是列表所在的区域
+    explicit ScrollTracker(const Rect& roi) :
+        m_roi(roi)
+    {
+    }
+
+    // 传入新的截图，返回列表相对上一张图的横向偏移（向左滑为负）
+    // 第一张图，或者两张图没有重叠的部分时返回 std::nullopt
+    std::optional<int> update(const cv::Mat& image);
+    void reset() noexcept;
+
+    std::optional<int> offset() const noexcept { return m_offset; }
+    // 把上一张图中的 rect 挪到当前图中的位置；没有偏移时返回 std::nullopt
+    std::optional<Rect> from_previous(const Rect& rect) const noexcept;
+
+private:
+    std::optional<int> estimate(const cv::Mat& image) const;
+
+    Rect m_roi;
+    cv::Mat m_prev_image;
+    std::optional<int> m_offset;
+};
+} // namespace asst
@@ -1,13 +1,15 @@
 #include "TemplDetOCRer.h"
 
 #include "Config/TaskData.h"
+#include "DigitOCRer.h"
 #include "MultiMatcher.h"
-#include "RegionOCRer.h"
+#include "Utils/Profiler.hpp"
 
 using namespace asst;
 
 TemplDetOCRer::ResultsVecOpt TemplDetOCRer::analyze() const
 {
+    ProfileScope("TemplDetOCRer::analyze", "vision");
     MultiMatcher flag_analyzer(m_image, m_roi);
     flag_analyzer.set_params(MatcherConfig::m_params);
 
@@ -21,9 +23,10 @@ TemplDetOCRer::ResultsVecOpt TemplDetOCRer::analyze() const
     for (const auto& matched : matched_vec) {
         Rect roi = matched.rect.move(m_flag_rect_move);
 
-        RegionOCRer ocr_analyzer(m_image, roi);
+        DigitOCRer ocr_analyzer(m_image, roi);
         ocr_analyzer.set_params(OCRerConfig::m_params);
         ocr_analyzer.set_use_raw(m_use_raw);
+        ocr_analyzer.set_glyph_set(m_digit_glyph_set);
         auto ocr_opt = ocr_analyzer.analyze();
         if (!ocr_opt) {
             continue;
@@ -26,6 +26,9 @@ public:
 
     void set_ocr_use_raw(bool use_raw) { m_use_raw = use_raw; }
 
+    // 非空时用 DigitOCRer 识别，仅适用于纯数字（及少量符号）的区域
+    void set_digit_glyph_set(std::string name) { m_digit_glyph_set = std::move(name); }
+
     ResultsVecOpt analyze() const;
 
     // FIXME: 老接口太难重构了，先弄个这玩意兼容下，后续慢慢全删掉
@@ -43,6 +46,7 @@ protected:
 private:
     Rect m_flag_rect_move;
     bool m_use_raw = true;
+    std::string m_digit_glyph_set;
 
 private:
     // FIXME: 老接口太难重构了，先弄个这玩意兼容下，后续慢慢全删掉
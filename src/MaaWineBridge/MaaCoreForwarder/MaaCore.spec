@@ -26,6 +26,8 @@
 @ stdcall AsstGetImage(ptr ptr long) WineShimAsstGetImage
 @ stdcall AsstGetUUID(ptr ptr long) WineShimAsstGetUUID
 @ stdcall AsstGetTasksList(ptr ptr long) WineShimAsstGetTasksList
+@ stdcall AsstGetMetrics(ptr ptr long) WineShimAsstGetMetrics
+@ stdcall AsstClearMetrics(ptr) WineShimAsstClearMetrics
 @ stdcall AsstGetNullSize() WineShimAsstGetNullSize
 
 @ stdcall AsstGetVersion() WineShimAsstGetVersion
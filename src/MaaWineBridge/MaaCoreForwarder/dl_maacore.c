@@ -38,6 +38,8 @@ void dl_init_maacore()
     FILL_DL_FUNC(maacore, AsstGetImage)
     FILL_DL_FUNC(maacore, AsstGetUUID)
     FILL_DL_FUNC(maacore, AsstGetTasksList)
+    FILL_DL_FUNC(maacore, AsstGetMetrics)
+    FILL_DL_FUNC(maacore, AsstClearMetrics)
     FILL_DL_FUNC(maacore, AsstGetNullSize)
 
     FILL_DL_FUNC(maacore, AsstGetVersion)
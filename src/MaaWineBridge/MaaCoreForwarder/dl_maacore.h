@@ -30,6 +30,8 @@ DEFINE_DL_FUNC(AsstAsyncScreencap)
 DEFINE_DL_FUNC(AsstGetImage)
 DEFINE_DL_FUNC(AsstGetUUID)
 DEFINE_DL_FUNC(AsstGetTasksList)
+DEFINE_DL_FUNC(AsstGetMetrics)
+DEFINE_DL_FUNC(AsstClearMetrics)
 DEFINE_DL_FUNC(AsstGetNullSize)
 
 DEFINE_DL_FUNC(AsstGetVersion)
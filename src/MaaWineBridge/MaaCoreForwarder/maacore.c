@@ -245,6 +245,16 @@ AsstSize __stdcall WineShimAsstGetTasksList(AsstHandle handle, AsstTaskId* buff,
     return dl_AsstGetTasksList(handle, buff, buff_size);
 }
 
+AsstSize __stdcall WineShimAsstGetMetrics(AsstHandle handle, char* buff, AsstSize buff_size)
+{
+    return dl_AsstGetMetrics(handle, buff, buff_size);
+}
+
+AsstBool __stdcall WineShimAsstClearMetrics(AsstHandle handle)
+{
+    return dl_AsstClearMetrics(handle);
+}
+
 AsstSize __stdcall WineShimAsstGetNullSize()
 {
     return dl_AsstGetNullSize();
@@ -2727,6 +2727,11 @@ namespace MaaWpfGui.Main
         /// 用GPU进行OCR
         /// </summary>
         GpuOCR,
+
+        /// <summary>
+        /// 异步写日志
+        /// </summary>
+        AsyncLog,
     }
 
     public enum InstanceOptionKey
@@ -2752,5 +2757,10 @@ namespace MaaWpfGui.Main
         /// Indicates whether the ADB server process should be killed when the instance is exited.
         /// </summary>
         KillAdbOnExit = 5,
+
+        /// <summary>
+        /// Starts ("1") or stops and exports ("0") the span profiler.
+        /// </summary>
+        Profiling = 6,
     }
 }
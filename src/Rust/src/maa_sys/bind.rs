@@ -118,6 +118,16 @@ extern "C" {
         buff_size: AsstSize,
     ) -> AsstSize;
 }
+extern "C" {
+    pub fn AsstGetMetrics(
+        handle: AsstHandle,
+        buff: *mut ::std::os::raw::c_char,
+        buff_size: AsstSize,
+    ) -> AsstSize;
+}
+extern "C" {
+    pub fn AsstClearMetrics(handle: AsstHandle) -> AsstBool;
+}
 extern "C" {
     pub fn AsstGetNullSize() -> AsstSize;
 }